@@ -1,4 +1,5 @@
 import {
+    ClientType,
     type ConfigBinding,
     ConfigManager,
     JsonSafeParse,
@@ -438,6 +439,18 @@ export default function buildBaseApi(server: Server) {
         calculate.free();
     });
 
+    server.app.route('/api/stats', 'GET', (req, res) => {
+        const stats = Object.values(req.instanceManager.osuInstances).map(
+            (instance) => ({
+                pid: instance.pid,
+                client: ClientType[instance.client],
+                memory: instance.process.getStats()
+            })
+        );
+
+        return sendJson(res, stats);
+    });
+
     server.app.route('/api/generateReport', 'GET', async (req, res) => {
         let report: Report;
         try {
@@ -11,13 +11,35 @@ import {
 } from '@tosu/common';
 import { Server } from '@tosu/server';
 import { autoUpdater, checkUpdates } from '@tosu/updater';
-import { Process } from 'tsprocess';
+import { LogLevel, LogRecord, Process } from 'tsprocess';
 
 import { InstanceManager } from '@/instances/manager';
 
 // NOTE: _version.js packs with pkg support in tosu build
 import { version as currentVersion } from './_version.js';
 
+const nativeLoggers = {
+    [LogLevel.Debug]: wLogger.debug,
+    [LogLevel.Info]: wLogger.info,
+    [LogLevel.Warn]: wLogger.warn,
+    [LogLevel.Error]: wLogger.error
+};
+
+function forwardNativeLogs() {
+    Process.setLogHandler(
+        (records: LogRecord[]) => {
+            for (const record of records) {
+                const message =
+                    record.suppressed > 0
+                        ? `${record.message} (suppressed ${record.suppressed} earlier messages from here)`
+                        : record.message;
+                nativeLoggers[record.level]('%tsprocess%', message);
+            }
+        },
+        config.debugLog === true ? LogLevel.Debug : LogLevel.Info
+    );
+}
+
 (async () => {
     context.currentVersion = currentVersion;
     wLogger.info(`Starting %tosu%`);
@@ -28,6 +50,7 @@ import { version as currentVersion } from './_version.js';
     const httpServer = new Server({ instanceManager });
 
     await configInitialization();
+    forwardNativeLogs();
 
     const { update, onedrive: onedriveBypass } = argumentsParser(process.argv);
 
@@ -83,6 +106,7 @@ import { version as currentVersion } from './_version.js';
         'change',
         instanceManager.handleConfigUpdate.bind(instanceManager)
     );
+    configEvents.addListener('change', forwardNativeLogs);
 
     if (config.enableIngameOverlay) instanceManager.startOverlay();
 })();
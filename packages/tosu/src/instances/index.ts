@@ -1,5 +1,13 @@
-import { Bitness, ClientType, config, sleep, wLogger } from '@tosu/common';
+import {
+    Bitness,
+    ClientType,
+    config,
+    getCachePath,
+    wLogger
+} from '@tosu/common';
 import EventEmitter from 'events';
+import fs from 'fs';
+import path from 'path';
 import { Process } from 'tsprocess';
 
 import { buildResult } from '@/api/utils/buildResult';
@@ -90,7 +98,7 @@ export abstract class AbstractInstance {
         this.set('lazerMultiSpectating', new LazerMultiSpectating(this));
         this.set('rankedPlay', new RankedPlay(this));
 
-        this.watchProcessHealth = this.watchProcessHealth.bind(this);
+        this.onProcessExit = this.onProcessExit.bind(this);
         this.preciseDataLoop = this.preciseDataLoop.bind(this);
     }
 
@@ -118,29 +126,40 @@ export abstract class AbstractInstance {
         return instance;
     }
 
-    private resolvePatterns(): boolean {
+    private async resolvePatterns(): Promise<boolean> {
         try {
             const scanPatterns = this.memory.getScanPatterns();
 
-            const results = this.process.scanBatch(
+            const results = await this.process.scanBatchAsync(
                 Object.values(scanPatterns).map((x) => {
                     return {
                         value: x.pattern,
                         nonZeroMask:
-                            x.nonZeroMask === undefined ? false : x.nonZeroMask
+                            x.nonZeroMask === undefined ? false : x.nonZeroMask,
+                        all: x.all
                     };
-                })
+                }),
+                path.join(getCachePath(), 'signatures.bin')
             );
 
             const patternsEntries = Object.entries(scanPatterns);
+            const candidates: Record<string, number[]> = {};
             for (let i = 0; i < results.length; i++) {
                 const item = results[i];
                 const pattern = patternsEntries[item.index];
+                const address = item.address + (pattern[1].offset || 0);
 
-                this.memory.setPattern(
-                    pattern[0],
-                    item.address + (pattern[1].offset || 0)
-                );
+                if (pattern[1].all) {
+                    if (!candidates[pattern[0]]) candidates[pattern[0]] = [];
+                    candidates[pattern[0]].push(address);
+                    continue;
+                }
+
+                this.memory.setPattern(pattern[0], address);
+            }
+
+            for (const [key, addresses] of Object.entries(candidates)) {
+                this.memory.setPatternCandidates(key, addresses);
             }
 
             if (!this.memory.checkIsBasesValid()) {
@@ -160,13 +179,17 @@ export abstract class AbstractInstance {
         }
     }
 
-    start(): boolean {
+    async start(): Promise<boolean> {
         wLogger.info(`%${ClientType[this.client]}%`, `Scanning memory...`);
 
+        if (config.debugLog) {
+            Process.startTrace();
+        }
+
         while (!this.isReady) {
             try {
                 const s1 = performance.now();
-                const result = this.resolvePatterns();
+                const result = await this.resolvePatterns();
                 if (!result) {
                     throw new Error('Memory resolve failed');
                 }
@@ -176,6 +199,7 @@ export abstract class AbstractInstance {
                     `%${ClientType[this.client]}%`,
                     `Memory patterns resolved in %${elapsedTime}%`
                 );
+                this.saveTrace();
 
                 this.isReady = true;
             } catch (exc) {
@@ -185,15 +209,38 @@ export abstract class AbstractInstance {
                     (exc as Error).message
                 );
                 wLogger.debug(`Pattern scan retry details:`, exc);
+                this.saveTrace();
                 return false;
             }
         }
 
         this.initiate();
-        this.watchProcessHealth();
         return true;
     }
 
+    /** Writes the native trace of the attach to the cache folder, debug only */
+    private saveTrace() {
+        if (!config.debugLog) {
+            return;
+        }
+
+        Process.stopTrace();
+
+        const tracePath = path.join(
+            getCachePath(),
+            `trace-${ClientType[this.client]}-${this.pid}.json`
+        );
+        try {
+            fs.writeFileSync(tracePath, Process.dumpTrace());
+            wLogger.debug(
+                `%${ClientType[this.client]}%`,
+                `Attach trace saved to %${tracePath}%`
+            );
+        } catch (exc) {
+            wLogger.debug(`Failed to save attach trace:`, exc);
+        }
+    }
+
     initiate() {
         this.regularDataLoop();
         this.preciseDataLoop();
@@ -202,19 +249,18 @@ export abstract class AbstractInstance {
     abstract regularDataLoop(): void;
     abstract preciseDataLoop(): void;
 
-    async watchProcessHealth() {
-        while (!this.isDestroyed) {
-            if (!Process.isProcessExist(this.process.handle)) {
-                wLogger.warn(
-                    `Client process %${ClientType[this.client]}% has terminated`
-                );
+    /** Called by the instance manager once the client process has exited */
+    onProcessExit() {
+        if (this.isDestroyed) {
+            return;
+        }
 
-                this.emitter.emit('onDestroy', this.pid);
-                this.isDestroyed = true;
-            }
+        wLogger.warn(
+            `Client process %${ClientType[this.client]}% has terminated`
+        );
 
-            await sleep(config.pollRate);
-        }
+        this.isDestroyed = true;
+        this.emitter.emit('onDestroy', this.pid);
     }
 
     setTourneyIpcId(ipcId: number) {
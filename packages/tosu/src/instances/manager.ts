@@ -11,7 +11,7 @@ import {
 import { runOverlay } from '@tosu/ingame-overlay-updater';
 import { ChildProcess } from 'node:child_process';
 import { setTimeout } from 'node:timers/promises';
-import { Process } from 'tsprocess';
+import { Process, type ProcessEvent, ProcessWatcher } from 'tsprocess';
 
 import type { AbstractInstance } from '@/instances';
 
@@ -30,6 +30,9 @@ export class InstanceManager {
     isOverlayStarted: boolean = false;
     overlayProcess: ChildProcess | null = null;
 
+    processWatcher: ProcessWatcher | null = null;
+    private processQueue: Promise<void> = Promise.resolve();
+
     constructor() {
         this.osuInstances = {};
     }
@@ -70,7 +73,12 @@ export class InstanceManager {
         delete this.osuInstances[pid];
     }
 
-    private async handleProcesses() {
+    /**
+     * Returns true if a client could not be started yet and should be retried
+     */
+    private async handleProcesses(): Promise<boolean> {
+        let retry = false;
+
         try {
             let osuProcesses = Process.findProcesses([
                 'osu!.exe',
@@ -116,8 +124,8 @@ export class InstanceManager {
 
                 const processHandle = Process.openProcess(processId);
                 const isProcessExist = Process.isProcessExist(processHandle);
+                Process.closeHandle(processHandle);
                 if (!isProcessExist) {
-                    Process.closeHandle(processHandle);
                     continue;
                 }
 
@@ -140,8 +148,9 @@ export class InstanceManager {
                 );
 
                 this.osuInstances[processId] = osuInstance;
-                if (!osuInstance.start()) {
+                if (!(await osuInstance.start())) {
                     this.onProcessDestroy(processId);
+                    retry = true;
                     continue;
                 }
 
@@ -155,14 +164,38 @@ export class InstanceManager {
         } catch (exc) {
             wLogger.error('Process management failed:', (exc as any).message);
             wLogger.debug('Process management error details:', exc);
+            retry = true;
         }
+
+        return retry;
     }
 
-    async runWatcher() {
-        while (true) {
-            await this.handleProcesses();
-            await setTimeout(1000);
+    private queueProcesses() {
+        this.processQueue = this.processQueue.then(async () => {
+            while (await this.handleProcesses()) {
+                await setTimeout(1000);
+            }
+        });
+    }
+
+    private onProcessEvents(events: ProcessEvent[]) {
+        for (const event of events) {
+            if (event.type === 'detach') {
+                this.osuInstances[event.pid]?.onProcessExit();
+            }
         }
+
+        if (events.some((r) => r.type === 'attach')) {
+            this.queueProcesses();
+        }
+    }
+
+    runWatcher() {
+        this.processWatcher = new ProcessWatcher(
+            ['osu!.exe', 'osulazer.exe', 'osu!'],
+            1000,
+            this.onProcessEvents.bind(this)
+        );
     }
 
     async runDetemination() {
@@ -7,6 +7,7 @@ import {
     wLogger
 } from '@tosu/common';
 import fs from 'fs';
+import { ChainType, MemoryWatch } from 'tsprocess';
 
 import { AbstractInstance } from '@/instances/index';
 import { StableMemory } from '@/memory/stable';
@@ -15,6 +16,8 @@ import { safeJoin } from '@/utils/converters';
 export class OsuInstance extends AbstractInstance {
     memory: StableMemory;
 
+    private statusChanged?: () => void;
+
     constructor(pid: number) {
         super(pid, Bitness.x86);
 
@@ -213,31 +216,64 @@ export class OsuInstance extends AbstractInstance {
         }
     }
 
+    /**
+     * Resolves once the watched game status changes or `timeout` passes
+     */
+    private waitForStatusChange(timeout: number): Promise<void> {
+        return new Promise((resolve) => {
+            const done = () => {
+                clearTimeout(timer);
+                this.statusChanged = undefined;
+                resolve();
+            };
+            const timer = setTimeout(done, timeout);
+
+            this.statusChanged = done;
+        });
+    }
+
     async preciseDataLoop(): Promise<void> {
         const { global, gameplay } = this.getServices(['global', 'gameplay']);
 
+        // playTime and the live data keep the precise cadence everywhere,
+        // the native watch only cuts the wait short when the status changes
+        // so the gameplay-only work starts right away
+        const statusWatch = new MemoryWatch(
+            this.process,
+            config.preciseDataPollRate,
+            () => this.statusChanged?.()
+        );
+        statusWatch.addChain(
+            this.memory.getPattern('statusPtr'),
+            [0, 0],
+            ChainType.Int
+        );
+
+        let isSampling = true;
+
         while (!this.isDestroyed) {
             try {
                 global.updatePreciseState();
                 if (global.status === GameState.exit) break;
 
-                switch (global.status) {
-                    case GameState.play:
-                        if (global.playTime < 150) {
-                            break;
-                        }
+                const isPlaying = global.status === GameState.play;
+                if (isPlaying !== isSampling) {
+                    this.memory.setPreciseSampling(isPlaying);
+                    isSampling = isPlaying;
 
-                        if (config.enableKeyOverlay) {
-                            gameplay.updateKeyOverlay();
-                        }
-                        gameplay.updateHitErrors();
-                        break;
-                    default:
+                    if (!isPlaying) {
                         gameplay.resetKeyOverlay();
-                        break;
+                    }
                 }
 
-                await sleep(config.preciseDataPollRate);
+                if (isPlaying && global.playTime >= 150) {
+                    if (config.enableKeyOverlay) {
+                        gameplay.updateKeyOverlay();
+                    }
+                    gameplay.updateHitErrors();
+                }
+
+                await this.waitForStatusChange(config.preciseDataPollRate);
             } catch (exc) {
                 wLogger.error(
                     `%${ClientType[this.client]}%`,
@@ -247,5 +283,8 @@ export class OsuInstance extends AbstractInstance {
                 wLogger.debug(`Precise loop error details:`, exc);
             }
         }
+
+        statusWatch.stop();
+        this.memory.stopSampler();
     }
 }
@@ -33,6 +33,7 @@ export abstract class AbstractMemory<M extends Record<string, number>> {
     game: AbstractInstance;
 
     private leaderStart: number = 0x8;
+    private patternCandidates: Partial<Record<keyof M, number[]>> = {};
 
     constructor(process: Process, instance: AbstractInstance) {
         this.process = process;
@@ -75,6 +76,24 @@ export abstract class AbstractMemory<M extends Record<string, number>> {
         return true;
     }
 
+    /**
+     * Stores every match of an `all` scan pattern, the lowest one becomes the pattern value
+     */
+    setPatternCandidates(key: keyof M, addresses: number[]): boolean {
+        this.patternCandidates[key] = addresses;
+        return this.setPattern(key, addresses[0] as M[keyof M]);
+    }
+
+    /**
+     * Returns candidates collected during the initial scan once, later lookups have to rescan
+     */
+    takePatternCandidates(key: keyof M): number[] | undefined {
+        const addresses = this.patternCandidates[key];
+        delete this.patternCandidates[key];
+
+        return addresses;
+    }
+
     getPattern(key: keyof M) {
         return this.patterns[key];
     }
@@ -17,6 +17,7 @@ import {
 } from '@tosu/common';
 import { getContentType } from '@tosu/server';
 import path from 'path';
+import { FieldType, StructLayout } from 'tsprocess';
 
 import localOffsets from '@/assets/offsets.json';
 import { LazerInstance } from '@/instances/lazerInstance';
@@ -428,6 +429,13 @@ const frameworkConfigList = [
     FrameworkSetting.CursorSensitivity
 ];
 
+/** Struct field read from `offsets[class][field] + adjust` */
+type StructFieldSchema<C extends keyof Offsets> = [
+    field: keyof Offsets[C] & string,
+    type: FieldType,
+    adjust?: number
+];
+
 // VTABLE FROM 2026.518.0
 const FALLBACK_GAME_BASE_VTABLE: number = 7730957910016;
 
@@ -438,7 +446,8 @@ export class LazerMemory extends AbstractMemory<LazerPatternData> {
         scalingContainerTargetDrawSize: {
             pattern: '01 01 00 00 00 00 80 44 00 00 40 44',
             offset: 0,
-            nonZeroMask: false
+            nonZeroMask: false,
+            all: true
         }
     };
 
@@ -463,6 +472,12 @@ export class LazerMemory extends AbstractMemory<LazerPatternData> {
 
     private isLeaderboardVisible: boolean = false;
 
+    // Reused by audioVelocityBase on every tick
+    private bassDensity = new Float32Array(40);
+
+    private structLayouts: Map<string, StructLayout> = new Map();
+    private structLayoutsOffsets: Offsets | null = null;
+
     patterns: LazerPatternData = {
         scalingContainerTargetDrawSize: 0
     };
@@ -484,14 +499,16 @@ export class LazerMemory extends AbstractMemory<LazerPatternData> {
         const oldAddress = this.gameBaseAddress;
 
         const scanPattern = this.scanPatterns.scalingContainerTargetDrawSize;
-        const candidates = this.process.scanAll(
-            scanPattern.pattern,
-            scanPattern.nonZeroMask
+        const initialCandidates = this.takePatternCandidates(
+            'scalingContainerTargetDrawSize'
         );
+        const candidates =
+            initialCandidates ||
+            this.process
+                .scanAll(scanPattern.pattern, scanPattern.nonZeroMask)
+                .map((match) => match + (scanPattern.offset || 0));
 
-        for (const match of candidates) {
-            const anchor = match + (scanPattern.offset || 0);
-
+        for (const anchor of candidates) {
             const gameBaseAddress = this.resolveGameBaseFromAnchor(anchor);
             if (gameBaseAddress === null) {
                 continue;
@@ -549,20 +566,17 @@ export class LazerMemory extends AbstractMemory<LazerPatternData> {
     }
 
     private checkIfGameBase(address: number): boolean {
-        try {
-            const vtable = this.process.readIntPtr(address);
+        // Runs on every update, failed reads return 0 instead of throwing
+        const vtable = this.process.tryReadIntPtr(address);
 
-            if (!vtable) {
-                return false;
-            }
-
-            const expected =
-                this.offsets.GameBaseVtable || FALLBACK_GAME_BASE_VTABLE;
-
-            return this.process.readLong(vtable) === expected;
-        } catch {
+        if (!vtable) {
             return false;
         }
+
+        const expected =
+            this.offsets.GameBaseVtable || FALLBACK_GAME_BASE_VTABLE;
+
+        return this.process.tryReadLong(vtable) === expected;
     }
 
     private gameBase() {
@@ -1247,6 +1261,14 @@ export class LazerMemory extends AbstractMemory<LazerPatternData> {
         inlined: boolean = false,
         structSize: number = 8
     ): number[] {
+        // Pointer arrays go through one bulk read, a bogus size falls back to
+        // the per item path which stops at the first unreadable item
+        if (!inlined && structSize === 8 && size > 0 && size <= 0x100000) {
+            return Array.from(
+                this.process.readPtrArray(items + 0x10, new Float64Array(size))
+            );
+        }
+
         const result: number[] = [];
         for (let i = 0; i < size; i++) {
             result.push(this.readItem(items, i, inlined, structSize));
@@ -1517,30 +1539,26 @@ export class LazerMemory extends AbstractMemory<LazerPatternData> {
             return statistics;
         }
 
-        const statisticsCount = this.process.readInt(statisticsDict + 0x38);
-
-        const statisticsEntries = this.process.readIntPtr(
-            statisticsDict + 0x10
-        );
-
-        if (!statisticsEntries) {
-            return statistics;
-        }
-
-        const items = this.readItems(
-            statisticsEntries,
-            statisticsCount,
-            true,
-            0x10
+        // Dictionary<HitResult, int>
+        const { keys, values } = this.process.readSharpDictionary(
+            statisticsDict,
+            {
+                entries: 0x10,
+                count: 0x38,
+                entrySize: 0x10,
+                next: 0x4,
+                key: [0x8, FieldType.Int],
+                value: [0xc, FieldType.Int]
+            }
         );
 
-        for (const item of items) {
-            const key = this.process.readInt(item + 0x8);
+        for (let i = 0; i < keys.length; i++) {
+            const key = keys[i];
             if (key === 0) {
                 continue;
             }
 
-            const value = this.process.readInt(item + 0xc);
+            const value = values[i];
 
             statistics[LazerHitResults[key] as keyof Statistics] = value;
         }
@@ -1565,71 +1583,114 @@ export class LazerMemory extends AbstractMemory<LazerPatternData> {
         return this.readStatisticsDict(statisticsDict);
     }
 
+    /**
+     * Compiles the fields of `className` into a native layout read with one
+     * call, offsets come from the loaded offsets.json so a new osu! version
+     * only needs a schema update. Cached until the offsets are reloaded
+     */
+    private getStructLayout<C extends keyof Offsets>(
+        name: string,
+        className: C,
+        fields: Record<string, StructFieldSchema<C>>
+    ): StructLayout {
+        if (this.structLayoutsOffsets !== this.offsets) {
+            this.structLayouts.clear();
+            this.structLayoutsOffsets = this.offsets;
+        }
+
+        const cached = this.structLayouts.get(name);
+        if (cached) return cached;
+
+        const offsets = this.offsets[className] as
+            | Record<string, number>
+            | undefined;
+        if (!offsets) {
+            throw new Error(`Offsets for ${String(className)} are missing`);
+        }
+
+        // The native side reads a non-finite offset as 0, which would
+        // silently return another field
+        const schema = Object.entries(fields).map(
+            ([key, [field, type, adjust]]) => {
+                const offset = offsets[field] + (adjust || 0);
+                if (!Number.isFinite(offset)) {
+                    throw new Error(
+                        `Offset ${String(className)}.${field} is missing`
+                    );
+                }
+
+                return { name: key, offset, type };
+            }
+        );
+
+        const layout = this.process.compileStruct(schema);
+
+        this.structLayouts.set(name, layout);
+        return layout;
+    }
+
     private readLeaderboardScore(
         scoreInfo: number,
         index: number
     ): LeaderboardPlayer {
         const mods = this.mods(scoreInfo);
 
-        const realmUser = this.process.readIntPtr(
-            scoreInfo +
-                this.offsets['osu.Game.Scoring.ScoreInfo'][
-                    '<RealmUser>k__BackingField'
-                ]
-        );
-        const username = this.process.readSharpStringPtr(
-            realmUser +
-                this.offsets['osu.Game.Models.RealmUser'][
-                    '<Username>k__BackingField'
-                ]
+        const score = this.process.readStruct<{
+            realmUser: number;
+            totalScore: number;
+            accuracy: number;
+            combo: number;
+            maxCombo: number;
+            passed: number;
+        }>(
+            this.getStructLayout(
+                'leaderboardScore',
+                'osu.Game.Scoring.ScoreInfo',
+                {
+                    realmUser: [
+                        '<RealmUser>k__BackingField',
+                        FieldType.Pointer
+                    ],
+                    totalScore: ['<TotalScore>k__BackingField', FieldType.Long],
+                    accuracy: ['<Accuracy>k__BackingField', FieldType.Double],
+                    combo: ['<Combo>k__BackingField', FieldType.Int],
+                    maxCombo: ['<MaxCombo>k__BackingField', FieldType.Int],
+                    passed: ['<Passed>k__BackingField', FieldType.Byte]
+                }
+            ),
+            scoreInfo
         );
-        const userId = this.process.readInt(
-            realmUser +
-                this.offsets['osu.Game.Models.RealmUser'][
-                    '<OnlineID>k__BackingField'
-                ]
+        if (score === null) {
+            throw new Error(`Couldn't read leaderboard score at ${scoreInfo}`);
+        }
+
+        const realmUser = this.process.readStruct<{
+            username: string;
+            userId: number;
+        }>(
+            this.getStructLayout('realmUser', 'osu.Game.Models.RealmUser', {
+                username: ['<Username>k__BackingField', FieldType.String],
+                userId: ['<OnlineID>k__BackingField', FieldType.Int]
+            }),
+            score.realmUser
         );
+        if (realmUser === null) {
+            throw new Error(`Couldn't read realm user at ${score.realmUser}`);
+        }
 
         const statistics = this.readStatistics(scoreInfo);
 
         return {
-            userId,
-            name: username,
+            userId: realmUser.userId,
+            name: realmUser.username,
             mods,
-            score: this.process.readLong(
-                scoreInfo +
-                    this.offsets['osu.Game.Scoring.ScoreInfo'][
-                        '<TotalScore>k__BackingField'
-                    ]
-            ),
+            score: score.totalScore,
             statistics,
-            accuracy:
-                this.process.readDouble(
-                    scoreInfo +
-                        this.offsets['osu.Game.Scoring.ScoreInfo'][
-                            '<Accuracy>k__BackingField'
-                        ]
-                ) * 100,
-            combo: this.process.readInt(
-                scoreInfo +
-                    this.offsets['osu.Game.Scoring.ScoreInfo'][
-                        '<Combo>k__BackingField'
-                    ]
-            ),
-            maxCombo: this.process.readInt(
-                scoreInfo +
-                    this.offsets['osu.Game.Scoring.ScoreInfo'][
-                        '<MaxCombo>k__BackingField'
-                    ]
-            ),
+            accuracy: score.accuracy * 100,
+            combo: score.combo,
+            maxCombo: score.maxCombo,
             team: 0,
-            isPassing:
-                this.process.readByte(
-                    scoreInfo +
-                        this.offsets['osu.Game.Scoring.ScoreInfo'][
-                            '<Passed>k__BackingField'
-                        ]
-                ) === 1,
+            isPassing: score.passed === 1,
             position: index + 1
         };
     }
@@ -1870,13 +1931,10 @@ export class LazerMemory extends AbstractMemory<LazerPatternData> {
                     .frequencyAmplitudes
         );
 
-        const result: number[] = [];
-        for (let i = 0; i < 40; i++) {
-            result.push(
-                this.process.readFloat(frequencyAmplitudes + 0x10 + 0x4 * i)
-            );
-        }
-        return result;
+        return this.process.readFloatArray(
+            frequencyAmplitudes + 0x10,
+            this.bassDensity
+        );
     }
 
     readUser(user: number) {
@@ -1920,38 +1978,46 @@ export class LazerMemory extends AbstractMemory<LazerPatternData> {
         let rank = 0;
 
         if (statistics) {
-            const ppDecimal =
-                statistics +
-                this.offsets['osu.Game.Users.UserStatistics'].PP +
-                0x8;
-
-            // TODO: read ulong instead long
-            pp = numberFromDecimal(
-                this.process.readLong(ppDecimal + 0x8),
-                this.process.readUInt(ppDecimal + 0x4),
-                this.process.readInt(ppDecimal)
+            const values = this.process.readStruct<{
+                ppFlags: number;
+                ppHigh: number;
+                ppLow: number;
+                accuracy: number;
+                rankedScore: number;
+                level: number;
+                playCount: number;
+                rank: number;
+            }>(
+                this.getStructLayout(
+                    'userStatistics',
+                    'osu.Game.Users.UserStatistics',
+                    {
+                        // decimal? PP, the decimal itself starts after HasValue
+                        ppFlags: ['PP', FieldType.Int, 0x8],
+                        ppHigh: ['PP', FieldType.UInt, 0xc],
+                        // TODO: read ulong instead long
+                        ppLow: ['PP', FieldType.Long, 0x10],
+                        accuracy: ['Accuracy', FieldType.Double],
+                        rankedScore: ['RankedScore', FieldType.Long],
+                        level: ['Level', FieldType.Int],
+                        playCount: ['PlayCount', FieldType.Int],
+                        rank: ['GlobalRank', FieldType.Int, 0x4]
+                    }
+                ),
+                statistics
             );
+            if (values === null) {
+                throw new Error(
+                    `Couldn't read user statistics at ${statistics}`
+                );
+            }
 
-            accuracy = this.process.readDouble(
-                statistics +
-                    this.offsets['osu.Game.Users.UserStatistics'].Accuracy
-            );
-            rankedScore = this.process.readLong(
-                statistics +
-                    this.offsets['osu.Game.Users.UserStatistics'].RankedScore
-            );
-            level = this.process.readInt(
-                statistics + this.offsets['osu.Game.Users.UserStatistics'].Level
-            );
-            playCount = this.process.readInt(
-                statistics +
-                    this.offsets['osu.Game.Users.UserStatistics'].PlayCount
-            );
-            rank = this.process.readInt(
-                statistics +
-                    this.offsets['osu.Game.Users.UserStatistics'].GlobalRank +
-                    0x4
-            );
+            pp = numberFromDecimal(values.ppLow, values.ppHigh, values.ppFlags);
+            accuracy = values.accuracy;
+            rankedScore = values.rankedScore;
+            level = values.level;
+            playCount = values.playCount;
+            rank = values.rank;
         }
 
         let gamemode =
@@ -6,6 +6,13 @@ import {
     wLogger
 } from '@tosu/common';
 import { getContentType } from '@tosu/server';
+import {
+    ChainType,
+    FieldType,
+    MemorySampler,
+    PointerChains,
+    type SamplerChannel
+} from 'tsprocess';
 
 import { type OsuVersion } from '@/instances';
 import { AbstractMemory } from '@/memory';
@@ -33,7 +40,7 @@ import type {
 } from '@/memory/types';
 import { defaultStatistics } from '@/states/gameplay';
 import type { ITourneyManagerChatItem } from '@/states/tourney';
-import type { LeaderboardPlayer } from '@/states/types';
+import type { KeyOverlayButton, LeaderboardPlayer } from '@/states/types';
 import { Bindings, VirtualKeyCode } from '@/utils/bindings';
 import { calculateAccuracy } from '@/utils/calculators';
 import { netDateBinaryToDate } from '@/utils/converters';
@@ -216,40 +223,128 @@ export class StableMemory extends AbstractMemory<OsuPatternData> {
     configPositions: number[] = [];
     bindingPositions: number[] = [];
 
+    // Reused by audioVelocityBase on every tick
+    private bassDensity = new Float32Array(40);
+
+    private chains = new Map<
+        string,
+        { rulesetsAddr: number; chains: PointerChains }
+    >();
+
+    // Key states and hit errors are sampled natively every millisecond while
+    // playing, and only every poll outside of gameplay
+    private sampler: MemorySampler | null = null;
+    private samplerChannels = new Map<
+        string,
+        { rulesetsAddr: number; channel: SamplerChannel }
+    >();
+    private hitErrorsTail: number[] = [];
+    private keyOverlayRow: Float64Array | null = null;
+
     getScanPatterns(): ScanPatterns {
         return this.scanPatterns;
     }
 
+    /**
+     * Returns the pointer chains compiled for `name`, they are rebuilt once the
+     * rulesets pattern moves. Ruleset = [[Rulesets - 0xB] + 0x4]
+     */
+    private getChains(
+        name: string,
+        build: (
+            chains: PointerChains,
+            ruleset: { base: number; offsets: number[] }
+        ) => void
+    ): PointerChains {
+        const rulesetsAddr = this.getPattern('rulesetsAddr');
+
+        const cached = this.chains.get(name);
+        if (cached && cached.rulesetsAddr === rulesetsAddr) {
+            return cached.chains;
+        }
+
+        const chains = new PointerChains(this.process);
+        build(chains, { base: rulesetsAddr, offsets: [-0xb, 0x4] });
+
+        this.chains.set(name, { rulesetsAddr, chains });
+        return chains;
+    }
+
+    /**
+     * Same as getChains for channels of the native sampler, which is created
+     * on first use
+     */
+    private getSamplerChannel(
+        name: string,
+        build: (
+            sampler: MemorySampler,
+            ruleset: { base: number; offsets: number[] }
+        ) => SamplerChannel
+    ): [MemorySampler, SamplerChannel] {
+        const rulesetsAddr = this.getPattern('rulesetsAddr');
+        const sampler = (this.sampler ??= new MemorySampler(this.process, 1));
+
+        const cached = this.samplerChannels.get(name);
+        if (cached && cached.rulesetsAddr === rulesetsAddr) {
+            return [sampler, cached.channel];
+        }
+
+        if (cached) sampler.remove(cached.channel);
+
+        const channel = build(sampler, {
+            base: rulesetsAddr,
+            offsets: [-0xb, 0x4]
+        });
+
+        this.samplerChannels.set(name, { rulesetsAddr, channel });
+        return [sampler, channel];
+    }
+
+    /**
+     * Samples at full rate only while precise data is needed
+     */
+    setPreciseSampling(active: boolean) {
+        this.sampler?.setInterval(active ? 1 : config.pollRate);
+    }
+
+    stopSampler() {
+        this.sampler?.stop();
+    }
+
     audioVelocityBase(): IAudioVelocityBase {
         if (this.process === null) {
             throw new Error('Process not found');
         }
 
-        // Ruleset = [[Rulesets - 0xB] + 0x4]
-        const rulesetAddr = this.process.readInt(
-            this.process.readInt(this.getPattern('rulesetsAddr') - 0xb) + 0x4
-        );
+        const chains = this.getChains('audioVelocityBase', (set, ruleset) => {
+            set.add(ruleset.base, ruleset.offsets, ChainType.Pointer);
+            // [Ruleset + 0x44] + 0x10
+            set.add(
+                ruleset.base,
+                [...ruleset.offsets, 0x44, 0x10],
+                ChainType.Pointer
+            );
+            set.add(
+                ruleset.base,
+                [...ruleset.offsets, 0x44, 0x10, 0x4],
+                ChainType.Int
+            );
+        });
+        chains.evaluate();
 
-        if (rulesetAddr === 0) return 'rulesetAddr is zero';
+        if (!chains.ok(0)) return 'rulesetAddr is zero';
+        if (!chains.ok(1)) return 'audioVelocityBase is zero';
 
-        // [Ruleset + 0x44] + 0x10
-        const audioVelocityBase = this.process.readInt(
-            this.process.readInt(rulesetAddr + 0x44) + 0x10
-        );
+        const audioVelocityBase = chains.value(1);
 
-        const bassDensityLength = this.process.readInt(audioVelocityBase + 0x4);
+        const bassDensityLength = chains.value(2);
         if (bassDensityLength < 40)
             return 'bassDensity length less than 40 (basically it have 1024 values)';
 
-        const result: number[] = [];
-        for (let i = 0; i < 40; i++) {
-            const current = audioVelocityBase + this.getLeaderStart() + 0x4 * i;
-            const value = this.process.readFloat(current);
-
-            result.push(value);
-        }
-
-        return result;
+        return this.process.readFloatArray(
+            audioVelocityBase + this.getLeaderStart(),
+            this.bassDensity
+        );
     }
 
     user(): IUser {
@@ -303,27 +398,24 @@ export class StableMemory extends AbstractMemory<OsuPatternData> {
         try {
             const result: number[] = [];
 
-            const rawSharpDictionary =
-                this.process.readSharpDictionary(address);
-            for (let i = 0; i < rawSharpDictionary.length; i++) {
-                const current = rawSharpDictionary[i];
-
-                try {
-                    const keyAddress = this.process.readInt(current);
-                    const key = this.process.readSharpString(keyAddress);
-
-                    if (!(key in configList)) {
-                        continue;
-                    }
+            // Dictionary<string, Bindable>
+            const { indices, keys } = this.process.readSharpDictionary<
+                string[]
+            >(address, {
+                entries: 0x8,
+                count: 0x1c,
+                entrySize: 0x10,
+                hash: 0x8,
+                key: [0x0, FieldType.String],
+                value: [0x4, FieldType.Pointer]
+            });
 
-                    result.push(i);
-                } catch (exc) {
-                    wLogger.debug(
-                        `%${ClientType[this.game.client]}%`,
-                        `Failed to read config offset:`,
-                        exc
-                    );
+            for (let i = 0; i < keys.length; i++) {
+                if (!(keys[i] in configList)) {
+                    continue;
                 }
+
+                result.push(indices[i]);
             }
 
             return result;
@@ -336,24 +428,23 @@ export class StableMemory extends AbstractMemory<OsuPatternData> {
         try {
             const result: number[] = [];
 
-            const rawSharpDictionary =
-                this.process.readSharpDictionary(address);
-            for (let i = 0; i < rawSharpDictionary.length; i++) {
-                const current = rawSharpDictionary[i];
-                try {
-                    const key = this.process.readInt(current);
-                    if (!(key in bindingList)) {
-                        continue;
-                    }
+            const { indices, keys } = this.process.readSharpDictionary(
+                address,
+                {
+                    entries: 0x8,
+                    count: 0x1c,
+                    entrySize: 0x10,
+                    key: [0x0, FieldType.Int],
+                    value: [0xc, FieldType.Int]
+                }
+            );
 
-                    result.push(i);
-                } catch (exc) {
-                    wLogger.debug(
-                        `%${ClientType[this.game.client]}%`,
-                        `Failed to read bindings offset:`,
-                        exc
-                    );
+            for (let i = 0; i < keys.length; i++) {
+                if (!(keys[i] in bindingList)) {
+                    continue;
                 }
+
+                result.push(indices[i]);
             }
 
             return result;
@@ -505,30 +596,45 @@ export class StableMemory extends AbstractMemory<OsuPatternData> {
 
     gameplay(): IGameplay {
         try {
-            const { baseAddr, rulesetsAddr } = this.getPatterns([
-                'baseAddr',
-                'rulesetsAddr'
-            ]);
+            const baseAddr = this.getPattern('baseAddr');
 
-            const rulesetAddr = this.process.readInt(
-                this.process.readInt(rulesetsAddr - 0xb) + 0x4
-            );
-            if (rulesetAddr === 0) {
+            const chains = this.getChains('gameplay', (set, ruleset) => {
+                set.add(ruleset.base, ruleset.offsets, ChainType.Pointer);
+                set.add(
+                    ruleset.base,
+                    [...ruleset.offsets, 0x64],
+                    ChainType.Pointer
+                );
+                set.add(
+                    ruleset.base,
+                    [...ruleset.offsets, 0x64, 0x38],
+                    ChainType.Pointer
+                );
+                set.add(
+                    ruleset.base,
+                    [...ruleset.offsets, 0x64, 0x40],
+                    ChainType.Pointer
+                );
+            });
+            chains.evaluate();
+
+            const rulesetAddr = chains.value(0);
+            if (!chains.ok(0)) {
                 return 'RulesetAddr is 0';
             }
 
-            const gameplayBase = this.process.readInt(rulesetAddr + 0x64);
-            if (gameplayBase === 0) {
+            const gameplayBase = chains.value(1);
+            if (!chains.ok(1)) {
                 return 'gameplayBase is zero';
             }
 
-            const scoreBase = this.process.readInt(gameplayBase + 0x38);
-            if (scoreBase === 0) {
+            const scoreBase = chains.value(2);
+            if (!chains.ok(2)) {
                 return 'scoreBase is zero';
             }
 
-            const hpBarBase = this.process.readInt(gameplayBase + 0x40);
-            if (hpBarBase === 0) {
+            const hpBarBase = chains.value(3);
+            if (!chains.ok(3)) {
                 return 'hpBar is zero';
             }
 
@@ -642,81 +748,83 @@ export class StableMemory extends AbstractMemory<OsuPatternData> {
 
     keyOverlay(mode: number): IKeyOverlay {
         try {
-            const address = this.getPattern('rulesetsAddr');
-            const rulesetAddr = this.process.readInt(
-                this.process.readInt(address - 0xb) + 0x4
+            const [sampler, channel] = this.getSamplerChannel(
+                'keyOverlay',
+                (sampler, ruleset) => {
+                    const chain = (offsets: number[], type: ChainType) =>
+                        this.process.compileChain(
+                            ruleset.base,
+                            [...ruleset.offsets, ...offsets],
+                            type
+                        );
+
+                    // [[Ruleset + 0xB0] + 0x10] + 0x4
+                    const arrayAddr = [0xac, 0x10, 0x4];
+                    const chains = [
+                        chain([], ChainType.Pointer),
+                        chain([0xac], ChainType.Pointer),
+                        chain(arrayAddr, ChainType.Pointer),
+                        chain([...arrayAddr, 0x4], ChainType.Int)
+                    ];
+
+                    for (let i = 0; i < 4; i++) {
+                        const key = [...arrayAddr, 0x8 + 0x4 * i];
+                        chains.push(chain([...key, 0x1c], ChainType.Byte));
+                        chains.push(chain([...key, 0x14], ChainType.Int));
+                    }
+
+                    this.keyOverlayRow = null;
+                    return sampler.snapshot(chains);
+                }
             );
-            if (rulesetAddr === 0) return 'rulesetAddr is zero';
 
-            const keyOverlayPtr = this.process.readUInt(rulesetAddr + 0xac);
-            if (keyOverlayPtr === 0) {
+            // Every row sampled since the last tick, a key counts as pressed
+            // if it was down in any of them
+            const rows = sampler.drain(channel);
+            const width = 12;
+            if (rows.length >= width) {
+                this.keyOverlayRow = rows.subarray(rows.length - width);
+            }
+
+            const row = this.keyOverlayRow;
+            if (row === null) return '';
+
+            if (Number.isNaN(row[0])) return 'rulesetAddr is zero';
+
+            if (Number.isNaN(row[1])) {
                 if (mode === 3 || mode === 1) return '';
 
-                return `keyOverlayPtr is zero [${keyOverlayPtr}] (${rulesetAddr}  -  ${address})`;
+                return `keyOverlayPtr is zero (${this.getPattern('rulesetsAddr')})`;
             }
 
-            // [[Ruleset + 0xB0] + 0x10] + 0x4
-            const keyOverlayArrayAddr = this.process.readInt(
-                this.process.readInt(keyOverlayPtr + 0x10) + 0x4
-            );
-            if (keyOverlayArrayAddr === 0) return 'keyOverlayAddr[] is zero';
+            if (Number.isNaN(row[2])) return 'keyOverlayAddr[] is zero';
 
-            const itemsSize = this.process.readInt(keyOverlayArrayAddr + 0x4);
+            const itemsSize = row[3];
             if (itemsSize < 4) {
                 return [];
             }
 
-            const keyOverlay = [
-                {
-                    name: mode === 2 ? 'L' : 'K1',
-                    isPressed: Boolean(
-                        this.process.readByte(
-                            this.process.readInt(keyOverlayArrayAddr + 0x8) +
-                                0x1c
-                        )
-                    ),
-                    count: this.process.readInt(
-                        this.process.readInt(keyOverlayArrayAddr + 0x8) + 0x14
-                    )
-                },
-                {
-                    name: mode === 2 ? 'R' : 'K2',
-                    isPressed: Boolean(
-                        this.process.readByte(
-                            this.process.readInt(keyOverlayArrayAddr + 0xc) +
-                                0x1c
-                        )
-                    ),
-                    count: this.process.readInt(
-                        this.process.readInt(keyOverlayArrayAddr + 0xc) + 0x14
-                    )
-                },
-                {
-                    name: mode === 2 ? 'D' : 'M1',
-                    isPressed: Boolean(
-                        this.process.readByte(
-                            this.process.readInt(keyOverlayArrayAddr + 0x10) +
-                                0x1c
-                        )
-                    ),
-                    count: this.process.readInt(
-                        this.process.readInt(keyOverlayArrayAddr + 0x10) + 0x14
-                    )
+            const names =
+                mode === 2 ? ['L', 'R', 'D', 'M2'] : ['K1', 'K2', 'M1', 'M2'];
+            const keys = mode === 0 ? 4 : 3;
+
+            const keyOverlay: KeyOverlayButton[] = [];
+            for (let i = 0; i < keys; i++) {
+                const isPressed = 4 + i * 2;
+                const count = isPressed + 1;
+                if (Number.isNaN(row[isPressed]) || Number.isNaN(row[count])) {
+                    return `keyOverlay key ${i} is not readable`;
+                }
+
+                let pressed = row[isPressed] > 0;
+                for (let r = isPressed; r < rows.length; r += width) {
+                    pressed ||= rows[r] > 0;
                 }
-            ];
 
-            if (mode === 0) {
                 keyOverlay.push({
-                    name: 'M2',
-                    isPressed: Boolean(
-                        this.process.readByte(
-                            this.process.readInt(keyOverlayArrayAddr + 0x14) +
-                                0x1c
-                        )
-                    ),
-                    count: this.process.readInt(
-                        this.process.readInt(keyOverlayArrayAddr + 0x14) + 0x14
-                    )
+                    name: names[i],
+                    isPressed: pressed,
+                    count: row[count]
                 });
             }
 
@@ -728,45 +836,52 @@ export class StableMemory extends AbstractMemory<OsuPatternData> {
 
     hitErrors(last: number): IHitErrors {
         try {
-            const rulesetsAddr = this.getPattern('rulesetsAddr');
-
-            const rulesetAddr = this.process.readInt(
-                this.process.readInt(rulesetsAddr - 0xb) + 0x4
+            const [sampler, channel] = this.getSamplerChannel(
+                'hitErrors',
+                (sampler, ruleset) => {
+                    // [[[Ruleset + 0x64] + 0x38] + 0x38]
+                    const list = [...ruleset.offsets, 0x64, 0x38, 0x38];
+
+                    this.hitErrorsTail = [];
+                    return sampler.tail({
+                        items: this.process.compileChain(
+                            ruleset.base,
+                            [...list, 0x4],
+                            ChainType.Pointer
+                        ),
+                        size: this.process.compileChain(
+                            ruleset.base,
+                            [...list, 0xc],
+                            ChainType.Int
+                        ),
+                        header: this.getLeaderStart(),
+                        type: FieldType.Int,
+                        // sometimes it returns number over a 1m and we dont need that
+                        min: -10_000,
+                        max: 10_000
+                    });
+                }
             );
-            if (rulesetAddr === 0) return 'RulesetAddr is 0';
-
-            const gameplayBase = this.process.readInt(rulesetAddr + 0x64);
-            if (gameplayBase === 0) return 'gameplayBase is zero';
-
-            const scoreBase = this.process.readInt(gameplayBase + 0x38);
-            if (scoreBase === 0) return 'scoreBase is zero';
-
-            const leaderStart = this.getLeaderStart();
 
-            const base = this.process.readInt(scoreBase + 0x38);
-            const items = this.process.readInt(base + 0x4);
-            const size = this.process.readInt(base + 0xc);
-
-            const result: number[] = [];
-            let index = last;
-            for (let i = last; i < size; i++) {
-                const item = items + leaderStart + 0x4 * i;
-                const error = this.process.readInt(item);
-
-                // sometimes it returns number over a 1m and we dont need that
-                if (error < -10_000 || error > 10_000) {
-                    wLogger.error(
-                        `%${ClientType[this.game.client]}%`,
-                        `strange value in hitErrors: %${error}%`
-                    );
-                    break;
+            // Records are [index, error] pairs, index 0 starts a new list
+            const records = sampler.drain(channel);
+            for (let i = 0; i < records.length; i += 2) {
+                if (records[i] < this.hitErrorsTail.length) {
+                    this.hitErrorsTail.length = records[i];
                 }
 
-                result.push(error);
-                index = i + 1;
+                this.hitErrorsTail.push(records[i + 1]);
+            }
+
+            // Wait for the caller to reset after a new list replaced the old one
+            if (last > this.hitErrorsTail.length) {
+                return { index: last, array: [] };
             }
 
-            return { index, array: result };
+            return {
+                index: this.hitErrorsTail.length,
+                array: this.hitErrorsTail.slice(last)
+            };
         } catch (error) {
             return error as Error;
         }
@@ -921,38 +1036,31 @@ export class StableMemory extends AbstractMemory<OsuPatternData> {
             const plays = this.process.readInt(
                 this.process.readInt(baseAddr - 0x33) + 0xc
             );
-            const artist = this.process.readSharpString(
-                this.process.readInt(beatmapAddr + 0x18)
-            );
-            const artistOriginal = this.process.readSharpString(
-                this.process.readInt(beatmapAddr + 0x1c)
-            );
-            const title = this.process.readSharpString(
-                this.process.readInt(beatmapAddr + 0x24)
-            );
-            const titleOriginal = this.process.readSharpString(
-                this.process.readInt(beatmapAddr + 0x28)
+            const strings = this.process.readSharpStrings(
+                [0x18, 0x1c, 0x24, 0x28, 0x64, 0x68, 0x78, 0x7c, 0xac].map(
+                    (offset) => this.process.readUInt(beatmapAddr + offset)
+                )
             );
+            if (strings.includes(null)) {
+                return new Error('Failed to read beatmap strings');
+            }
+
+            const [
+                artist,
+                artistOriginal,
+                title,
+                titleOriginal,
+                audioFilename,
+                backgroundFilename,
+                folder,
+                creator,
+                difficulty
+            ] = strings as string[];
 
             const ar = this.process.readFloat(beatmapAddr + 0x2c);
             const cs = this.process.readFloat(beatmapAddr + 0x30);
             const hp = this.process.readFloat(beatmapAddr + 0x34);
             const od = this.process.readFloat(beatmapAddr + 0x38);
-            const audioFilename = this.process.readSharpString(
-                this.process.readInt(beatmapAddr + 0x64)
-            );
-            const backgroundFilename = this.process.readSharpString(
-                this.process.readInt(beatmapAddr + 0x68)
-            );
-            const folder = this.process.readSharpString(
-                this.process.readInt(beatmapAddr + 0x78)
-            );
-            const creator = this.process.readSharpString(
-                this.process.readInt(beatmapAddr + 0x7c)
-            );
-            const difficulty = this.process.readSharpString(
-                this.process.readInt(beatmapAddr + 0xac)
-            );
             const mapID = this.process.readInt(beatmapAddr + 0xc8);
             const setID = this.process.readInt(beatmapAddr + 0xcc);
             const objectCount = this.process.readInt(beatmapAddr + 0xf8);
@@ -1221,25 +1329,19 @@ export class StableMemory extends AbstractMemory<OsuPatternData> {
 
             const currentPlayer = this.leaderboardPlayer(playerBase, mode);
 
-            const playersAddr = this.process.readInt(address + 0x4);
-            const slotsAmount = this.process.readInt(playersAddr + 0xc);
-            if (slotsAmount < 1) {
+            // List<ScoreboardEntry>, read with one call for the list and one
+            // for its items
+            const players = this.process.readSharpList(
+                this.process.readUInt(address + 0x4)
+            );
+            if (players.length < 1) {
                 return [Boolean(isVisible), currentPlayer, []];
             }
 
             const result: LeaderboardPlayer[] = [];
 
-            const itemsBase = this.process.readInt(playersAddr + 0x4);
-            const itemsSize = this.process.readInt(playersAddr + 0xc);
-            const leaderStart = this.getLeaderStart();
-
-            for (let i = 0; i < itemsSize; i++) {
-                const current = itemsBase + leaderStart + 0x4 * i;
-
-                const lbEntry = this.leaderboardPlayer(
-                    this.process.readInt(current),
-                    mode
-                );
+            for (let i = 0; i < players.length; i++) {
+                const lbEntry = this.leaderboardPlayer(players[i], mode);
 
                 if (!lbEntry) {
                     // break due to un-consistency of leaderboard
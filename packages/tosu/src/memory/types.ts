@@ -16,10 +16,12 @@ export type ScanPatterns = {
         offset?: number;
         nonZeroMask?: boolean;
         isTourneyOnly?: boolean;
+        // collect every match as candidates instead of the first one
+        all?: boolean;
     };
 };
 
-export type IAudioVelocityBase = number[] | string;
+export type IAudioVelocityBase = Float32Array | string;
 
 export interface IMatchmakingStats {
     rating: number;
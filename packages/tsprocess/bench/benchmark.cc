@@ -0,0 +1,537 @@
+// Standalone benchmark of the scan kernels and the read paths, built only with `npm run benchmark`.
+//
+// Scans run over a synthetic buffer with the stable and lazer signatures planted near its end, so every pass covers the
+// whole buffer and every result can be checked against a known offset. Process reads go to a forked copy of this
+// process, which has the same buffer at the same address. Results are printed as one JSON document on stdout.
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "memory/memory.h"
+#include "memory/scanner.h"
+
+namespace {
+
+// Signatures tosu scans for, see packages/tosu/src/memory/stable.ts and lazer.ts
+constexpr std::string_view signatures[] = {
+  "F8 01 74 04 83 65",
+  "5E 5F 5D C3 A1 ?? ?? ?? ?? 89 ?? 04",
+  "8B CE 83 3D ?? ?? ?? ?? 00 75 ?? 80",
+  "74 2C 85 FF 75 28 A1 ?? ?? ?? ?? 8D 15",
+  "83 E0 20 85 C0 7E 2F",
+  "8D 7D D0 B9 08 00 00 00 33 C0 F3 AB 8B CE 89 4D DC B9",
+  "7D 15 A1 ?? ?? ?? ?? 85 C0",
+  "55 8B EC 80 3D ?? ?? ?? ?? 00 75 26 80 3D",
+  "48 83 F8 04 73 1E",
+  "C8 FF ?? ?? ?? ?? ?? 81 0D ?? ?? ?? ?? ?? 08 00 00",
+  "55 8B EC 83 EC 08 A1 ?? ?? ?? ?? 85 C0",
+  "FF 15 ?? ?? ?? ?? A1 ?? ?? ?? ?? 8B 48 54 33 D2",
+  "B8 0B 00 00 8B 35",
+  "8B 0D ?? ?? ?? ?? 85 C0 74 05 8B 50 30",
+  "A1 ?? ?? ?? ?? 89 46 04 8B D6 E8",
+  "01 01 00 00 00 00 80 44 00 00 40 44",
+};
+
+constexpr std::size_t pattern_counts[] = {1, 10, 50};
+constexpr std::size_t max_patterns = 50;
+// Planted signatures are this far apart, counted back from the end of the buffer
+constexpr std::size_t plant_stride = 0x1000;
+
+constexpr std::size_t small_read_count = 200000;
+constexpr std::size_t batch_size = 64;
+constexpr std::size_t large_read_size = 0x400000;
+
+// Bytes that dominate x86 code and managed heaps, so anchors hit about as often as in a real osu! process
+constexpr uint8_t common_bytes[] = {0x00, 0x00, 0x00, 0x00, 0xFF, 0x8B, 0x89, 0x48, 0x83, 0xE8, 0xC3, 0x55, 0x5D,
+                                    0x85, 0xC0, 0x74, 0x75, 0x0F, 0x45, 0x04, 0x08, 0x01, 0xEC, 0xCC, 0xA1, 0x33};
+
+struct Options {
+  std::size_t size = 256 << 20;
+  int repeat = 5;
+};
+
+struct Signature {
+  std::vector<uint8_t> bytes;
+  std::vector<uint8_t> mask;
+};
+
+class Random {
+ public:
+  explicit Random(uint64_t seed) : state_(seed) {}
+
+  uint64_t next() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 7;
+    state_ ^= state_ << 17;
+    return state_;
+  }
+
+ private:
+  uint64_t state_;
+};
+
+Signature parse_signature(std::string_view text) {
+  auto signature = Signature{};
+
+  for (std::size_t i = 0; i < text.size(); i += 3) {
+    const auto byte = text.substr(i, 2);
+    if (byte == "??") {
+      signature.bytes.push_back(0);
+      signature.mask.push_back(0);
+      continue;
+    }
+
+    uint8_t value = 0;
+    std::from_chars(byte.data(), byte.data() + byte.size(), value, 16);
+    signature.bytes.push_back(value);
+    signature.mask.push_back(1);
+  }
+
+  return signature;
+}
+
+// The real signatures followed by variants of them with the same wildcard layout and different exact bytes.
+std::vector<Signature> make_signatures() {
+  auto result = std::vector<Signature>();
+  for (const auto text : signatures) {
+    result.push_back(parse_signature(text));
+  }
+
+  auto random = Random(0x5eed);
+  const auto real_count = result.size();
+  for (std::size_t i = 0; result.size() < max_patterns; ++i) {
+    auto variant = result[i % real_count];
+    for (std::size_t j = 0; j < variant.bytes.size(); ++j) {
+      if (variant.mask[j] != 0 && random.next() % 2 == 0) {
+        variant.bytes[j] = common_bytes[random.next() % std::size(common_bytes)];
+      }
+    }
+
+    // A duplicate would be found at the planted copy of the other signature
+    const auto duplicate = std::any_of(result.begin(), result.end(), [&](const Signature &other) {
+      return other.bytes == variant.bytes && other.mask == variant.mask;
+    });
+    if (!duplicate) {
+      result.push_back(std::move(variant));
+    }
+  }
+
+  return result;
+}
+
+std::vector<scanner::CompiledPattern> compile(const std::vector<Signature> &signatures, std::size_t count) {
+  auto result = std::vector<scanner::CompiledPattern>();
+  for (std::size_t i = 0; i < count; ++i) {
+    result.emplace_back(signatures[i].bytes, signatures[i].mask, false);
+  }
+  return result;
+}
+
+std::size_t planted_offset(std::size_t size, std::size_t pattern) {
+  return size - (pattern + 1) * plant_stride;
+}
+
+// Fills the buffer with code-like bytes, removes accidental matches of every signature and plants each one once.
+void fill_buffer(std::span<uint8_t> buffer, const std::vector<Signature> &signatures) {
+  auto random = Random(0xb0b);
+  for (auto &byte : buffer) {
+    const auto value = random.next();
+    byte = value & 1 ? common_bytes[(value >> 8) % std::size(common_bytes)] : static_cast<uint8_t>(value >> 16);
+  }
+
+  for (const auto &pattern : compile(signatures, signatures.size())) {
+    const auto anchor = pattern.exact_positions().front();
+    for (auto offset = pattern.find(buffer); offset != scanner::CompiledPattern::npos;
+         offset = pattern.find(buffer, offset + 1)) {
+      buffer[offset + anchor] ^= 0x80;
+    }
+  }
+
+  for (std::size_t i = 0; i < signatures.size(); ++i) {
+    const auto &signature = signatures[i];
+    const auto offset = planted_offset(buffer.size(), i);
+    for (std::size_t j = 0; j < signature.bytes.size(); ++j) {
+      if (signature.mask[j] != 0) {
+        buffer[offset + j] = signature.bytes[j];
+      }
+    }
+  }
+}
+
+template <class F>
+double median_seconds(int repeat, F &&run) {
+  auto samples = std::vector<double>();
+  for (int i = 0; i < repeat; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    samples.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+std::string_view isa_name(scanner::Isa isa) {
+  switch (isa) {
+    case scanner::Isa::scalar:
+      return "scalar";
+    case scanner::Isa::sse2:
+      return "sse2";
+    case scanner::Isa::avx2:
+      return "avx2";
+    case scanner::Isa::avx512:
+      return "avx512";
+  }
+
+  return "unknown";
+}
+
+std::string_view backend_name(memory::ReadBackend backend) {
+  switch (backend) {
+    case memory::ReadBackend::automatic:
+      return "automatic";
+    case memory::ReadBackend::vm_readv:
+      return "vm_readv";
+    case memory::ReadBackend::proc_mem:
+      return "proc_mem";
+  }
+
+  return "unknown";
+}
+
+// One measurement, parameters left at their defaults are omitted from the output
+struct Result {
+  std::string_view name;
+  // Empty for results that do not depend on the scan kernel or the read backend
+  std::string_view isa = {};
+  std::string_view backend = {};
+  std::size_t patterns = 0;
+  std::size_t size = 0;
+  std::size_t batch = 0;
+  double value = 0;
+  std::string_view unit = {};
+  bool verified = true;
+};
+
+class Report {
+ public:
+  void add(const Result &result) {
+    std::fprintf(stderr, "%-28s %-8s %-9s %3zu %8zu %3zu %12.4f %s%s\n", std::string(result.name).c_str(),
+                 std::string(result.isa).c_str(), std::string(result.backend).c_str(), result.patterns, result.size,
+                 result.batch, result.value, std::string(result.unit).c_str(), result.verified ? "" : "  MISMATCH");
+    results_.push_back(result);
+  }
+
+  void print(const Options &options) const {
+    std::printf("{\"benchmark\":\"tsprocess\",\"isa\":\"%s\",\"buffer_size\":%zu,\"repeat\":%d,\"results\":[",
+                std::string(isa_name(scanner::detect_isa())).c_str(), options.size, options.repeat);
+
+    for (std::size_t i = 0; i < results_.size(); ++i) {
+      const auto &result = results_[i];
+      std::printf("%s{\"name\":\"%s\"", i == 0 ? "" : ",", std::string(result.name).c_str());
+      if (!result.isa.empty()) {
+        std::printf(",\"isa\":\"%s\"", std::string(result.isa).c_str());
+      }
+      if (!result.backend.empty()) {
+        std::printf(",\"backend\":\"%s\"", std::string(result.backend).c_str());
+      }
+      if (result.patterns != 0) {
+        std::printf(",\"patterns\":%zu", result.patterns);
+      }
+      if (result.size != 0) {
+        std::printf(",\"size\":%zu", result.size);
+      }
+      if (result.batch != 0) {
+        std::printf(",\"batch\":%zu", result.batch);
+      }
+      std::printf(",\"value\":%.4f,\"unit\":\"%s\",\"verified\":%s}", result.value,
+                  std::string(result.unit).c_str(), result.verified ? "true" : "false");
+    }
+
+    std::printf("]}\n");
+  }
+
+ private:
+  std::vector<Result> results_;
+};
+
+double gigabytes_per_second(std::size_t bytes, double seconds) {
+  return static_cast<double>(bytes) / seconds / 1e9;
+}
+
+// Single pattern kernel: every signature is searched over the whole buffer in turn.
+void bench_find(Report &report, const Options &options, std::span<const uint8_t> buffer,
+                const std::vector<Signature> &signatures) {
+  const auto patterns = compile(signatures, std::size(::signatures));
+
+  for (auto isa = static_cast<int>(scanner::Isa::scalar); isa <= static_cast<int>(scanner::detect_isa()); ++isa) {
+    scanner::set_isa(static_cast<scanner::Isa>(isa));
+
+    auto verified = true;
+    const auto seconds = median_seconds(options.repeat, [&] {
+      for (std::size_t i = 0; i < patterns.size(); ++i) {
+        verified = verified && patterns[i].find(buffer) == planted_offset(buffer.size(), i);
+      }
+    });
+
+    report.add(Result{
+      .name = "scan.find",
+      .isa = isa_name(scanner::active_isa()),
+      .patterns = patterns.size(),
+      .value = gigabytes_per_second(buffer.size() * patterns.size(), seconds),
+      .unit = "GB/s",
+      .verified = verified,
+    });
+  }
+
+  scanner::set_isa(scanner::detect_isa());
+}
+
+// Multi pattern kernel: one pass over the whole buffer for 1, 10 and 50 patterns.
+void bench_multi_pattern(Report &report, const Options &options, std::span<const uint8_t> buffer,
+                         const std::vector<Signature> &signatures) {
+  for (auto isa = static_cast<int>(scanner::Isa::scalar); isa <= static_cast<int>(scanner::detect_isa()); ++isa) {
+    scanner::set_isa(static_cast<scanner::Isa>(isa));
+
+    for (const auto count : pattern_counts) {
+      const auto matcher = scanner::MultiPattern(compile(signatures, count));
+
+      auto verified = true;
+      const auto seconds = median_seconds(options.repeat, [&] {
+        auto found = std::vector<std::size_t>(count, scanner::CompiledPattern::npos);
+        auto active = std::vector<uint8_t>(count, 1);
+        matcher.scan(buffer, buffer.size(), active, [&](std::size_t pattern, std::size_t offset) {
+          found[pattern] = offset;
+          active[pattern] = 0;
+        });
+
+        for (std::size_t i = 0; i < count; ++i) {
+          verified = verified && found[i] == planted_offset(buffer.size(), i);
+        }
+      });
+
+      report.add(Result{
+        .name = "scan.multi_pattern",
+        .isa = isa_name(scanner::active_isa()),
+        .patterns = count,
+        .value = gigabytes_per_second(buffer.size(), seconds),
+        .unit = "GB/s",
+        .verified = verified,
+      });
+    }
+  }
+
+  scanner::set_isa(scanner::detect_isa());
+}
+
+// Whole pipeline against the target: region query, chunked reads and the scan pool.
+void bench_batch_find_pattern(Report &report, const Options &options, void *process, std::span<uint8_t> buffer,
+                              std::vector<Signature> &signatures) {
+  const auto base = reinterpret_cast<uintptr_t>(buffer.data());
+  auto filter = RegionFilter{};
+  filter.start = base;
+  filter.end = base + buffer.size();
+
+  for (const auto count : pattern_counts) {
+    auto verified = true;
+    const auto seconds = median_seconds(options.repeat, [&] {
+      auto patterns = std::vector<Pattern>();
+      for (std::size_t i = 0; i < count; ++i) {
+        patterns.push_back(Pattern{static_cast<int>(i), signatures[i].bytes, signatures[i].mask, false, false, false});
+      }
+
+      const auto results = memory::batch_find_pattern(process, std::move(patterns), nullptr, filter);
+      verified = verified && results.size() == count;
+      for (const auto &result : results) {
+        verified = verified && result.address == base + planted_offset(buffer.size(), result.index);
+      }
+    });
+
+    report.add(Result{
+      .name = "process.batch_find_pattern",
+      .patterns = count,
+      .value = gigabytes_per_second(buffer.size(), seconds),
+      .unit = "GB/s",
+      .verified = verified,
+    });
+  }
+}
+
+void bench_reads(Report &report, const Options &options, void *process, std::span<const uint8_t> buffer) {
+  const auto base = reinterpret_cast<uintptr_t>(buffer.data());
+
+  auto random = Random(0x4ead);
+  auto offsets = std::vector<std::size_t>(small_read_count);
+  for (auto &offset : offsets) {
+    offset = random.next() % (buffer.size() - sizeof(uint64_t));
+  }
+
+  for (const auto backend : {memory::ReadBackend::vm_readv, memory::ReadBackend::proc_mem}) {
+    if (!memory::set_read_backend(process, backend)) {
+      continue;
+    }
+
+    const auto name = backend_name(backend);
+
+    auto verified = true;
+    auto seconds = median_seconds(options.repeat, [&] {
+      for (const auto offset : offsets) {
+        const auto [value, success] = memory::read<uint64_t>(process, base + offset);
+        verified = verified && success && std::memcmp(&value, buffer.data() + offset, sizeof(value)) == 0;
+      }
+    });
+    report.add(Result{
+      .name = "process.read",
+      .backend = name,
+      .size = sizeof(uint64_t),
+      .value = seconds * 1e9 / static_cast<double>(offsets.size()),
+      .unit = "ns/op",
+      .verified = verified,
+    });
+
+    auto requests = std::vector<ReadRequest>();
+    for (const auto offset : offsets) {
+      requests.push_back(ReadRequest{base + offset, sizeof(uint64_t)});
+    }
+    auto out = std::vector<uint8_t>(batch_size * sizeof(uint64_t));
+    auto success = std::vector<uint8_t>(batch_size / 8);
+
+    verified = true;
+    seconds = median_seconds(options.repeat, [&] {
+      for (std::size_t i = 0; i + batch_size <= requests.size(); i += batch_size) {
+        const auto batch = std::span<const ReadRequest>(requests).subspan(i, batch_size);
+        verified = verified && memory::read_batch(process, batch, out.data(), success.data()) == batch_size;
+      }
+    });
+    report.add(Result{
+      .name = "process.read_batch",
+      .backend = name,
+      .size = sizeof(uint64_t),
+      .batch = batch_size,
+      .value = seconds * 1e9 / static_cast<double>(requests.size() / batch_size * batch_size),
+      .unit = "ns/op",
+      .verified = verified,
+    });
+
+    auto large = std::vector<uint8_t>(large_read_size);
+    const auto large_count = buffer.size() / large.size();
+    verified = true;
+    seconds = median_seconds(options.repeat, [&] {
+      for (std::size_t i = 0; i < large_count; ++i) {
+        verified = verified && memory::read_buffer(process, base + i * large.size(), large.size(), large.data());
+      }
+    });
+    // Only the last chunk is compared, checking all of them would dominate the timing
+    const auto last = buffer.data() + (large_count - 1) * large.size();
+    verified = verified && std::memcmp(large.data(), last, large.size()) == 0;
+    report.add(Result{
+      .name = "process.read",
+      .backend = name,
+      .size = large.size(),
+      .value = gigabytes_per_second(large_count * large.size(), seconds),
+      .unit = "GB/s",
+      .verified = verified,
+    });
+  }
+
+  memory::set_read_backend(process, memory::ReadBackend::automatic);
+}
+
+bool parse_options(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    const auto arg = std::string_view(argv[i]);
+    const auto separator = arg.find('=');
+    const auto key = arg.substr(0, separator);
+    const auto value = separator == std::string_view::npos ? std::string_view() : arg.substr(separator + 1);
+
+    std::size_t number = 0;
+    if (std::from_chars(value.data(), value.data() + value.size(), number).ec != std::errc() || number == 0) {
+      return false;
+    }
+
+    if (key == "--size-mb") {
+      options.size = number << 20;
+    } else if (key == "--repeat") {
+      options.repeat = static_cast<int>(number);
+    } else {
+      return false;
+    }
+  }
+
+  return options.size >= max_patterns * plant_stride + large_read_size;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  auto options = Options{};
+  if (!parse_options(argc, argv, options)) {
+    std::fprintf(stderr, "usage: %s [--size-mb=256] [--repeat=5]\n", argv[0]);
+    return 1;
+  }
+
+  auto signatures = make_signatures();
+
+  const auto mapping = mmap(nullptr, options.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED) {
+    std::perror("mmap");
+    return 1;
+  }
+  const auto buffer = std::span<uint8_t>(static_cast<uint8_t *>(mapping), options.size);
+  fill_buffer(buffer, signatures);
+
+  auto report = Report();
+  bench_find(report, options, buffer, signatures);
+  bench_multi_pattern(report, options, buffer, signatures);
+
+  // The child shares the filled buffer at the same address and only waits for the pipe to close
+  int pipe_fds[2];
+  if (pipe(pipe_fds) != 0) {
+    std::perror("pipe");
+    return 1;
+  }
+
+  const auto child = fork();
+  if (child < 0) {
+    std::perror("fork");
+    return 1;
+  }
+
+  if (child == 0) {
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    close(pipe_fds[1]);
+    char byte;
+    while (read(pipe_fds[0], &byte, 1) > 0) {
+    }
+    _exit(0);
+  }
+
+  close(pipe_fds[0]);
+
+  const auto process = memory::open_process(static_cast<uint32_t>(child));
+  if (process == nullptr) {
+    std::fprintf(stderr, "could not open the target process %d\n", child);
+  } else {
+    bench_batch_find_pattern(report, options, process, buffer, signatures);
+    bench_reads(report, options, process, buffer);
+    memory::close_handle(process);
+  }
+
+  close(pipe_fds[1]);
+  waitpid(child, nullptr, 0);
+
+  report.print(options);
+  return process == nullptr ? 1 : 0;
+}
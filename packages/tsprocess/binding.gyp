@@ -1,8 +1,11 @@
 {
+  'variables': {
+    'build_benchmark%': 'false',
+  },
   'targets': [
     {
       'target_name': 'tsprocess',
-      'sources': [ 'lib/functions.cc', 'lib/memory/memory_linux.cc', 'lib/memory/memory_windows.cc' ],
+      'sources': [ 'lib/functions.cc', 'lib/memory/memory_linux.cc', 'lib/memory/memory_windows.cc', 'lib/memory/scanner.cc', 'lib/memory/scan_pool.cc', 'lib/memory/scan_cache.cc', 'lib/memory/pointer_chain.cc', 'lib/memory/struct_layout.cc', 'lib/memory/collections.cc', 'lib/memory/csharp_string.cc', 'lib/memory/watcher.cc', 'lib/memory/sampler.cc', 'lib/memory/job_queue.cc', 'lib/memory/process_watcher.cc', 'lib/memory/address_map.cc', 'lib/memory/soft_dirty.cc', 'lib/memory/stats.cc', 'lib/memory/tracer.cc', 'lib/logger.cc' ],
       'include_dirs': ["<!@(node -p \"require('node-addon-api').include\")"],
       'dependencies': ["<!(node -p \"require('node-addon-api').gyp\")"],
       "cflags_cc": ["-std=c++20", "-fno-exceptions"],
@@ -23,5 +26,18 @@
           }
         ]
     }
+  ],
+  'conditions': [
+    ['build_benchmark=="true" and OS=="linux"', {
+      'targets': [
+        {
+          'target_name': 'tsprocess_benchmark',
+          'type': 'executable',
+          'sources': [ 'bench/benchmark.cc', 'lib/memory/memory_linux.cc', 'lib/memory/scanner.cc', 'lib/memory/scan_pool.cc', 'lib/memory/address_map.cc', 'lib/memory/stats.cc', 'lib/memory/tracer.cc', 'lib/logger.cc' ],
+          'include_dirs': [ 'lib' ],
+          "cflags_cc": ["-std=c++20", "-fno-exceptions"],
+        }
+      ]
+    }]
   ]
 }
\ No newline at end of file
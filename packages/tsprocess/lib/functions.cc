@@ -1,8 +1,23 @@
 #include <napi.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
 #include <string>
-#include <thread>
+#include <unordered_map>
 #include "logger.h"
+#include "memory/collections.h"
+#include "memory/csharp_string.h"
+#include "memory/job_queue.h"
 #include "memory/memory.h"
+#include "memory/pointer_chain.h"
+#include "memory/process_watcher.h"
+#include "memory/sampler.h"
+#include "memory/scan_cache.h"
+#include "memory/stats.h"
+#include "memory/struct_layout.h"
+#include "memory/tracer.h"
+#include "memory/watcher.h"
 
 #if defined(WIN32) || defined(_WIN32)
 #include <Windows.h>
@@ -18,6 +33,394 @@ intptr_t get_intptr_value(Napi::Value address_value, Napi::Value bitness_value)
                        : static_cast<intptr_t>(address_number.Uint32Value());
 }
 
+// Compiled struct layout together with the property names its fields are decoded into.
+struct StructSchema {
+  struct_layout::Layout layout;
+  std::vector<Napi::Reference<Napi::String>> names;
+};
+
+// Bytes behind an ArrayBuffer or the window of a TypedArray, empty for anything else.
+std::span<uint8_t> view_bytes(Napi::Value value) {
+  if (value.IsTypedArray()) {
+    auto array = value.As<Napi::TypedArray>();
+    auto data = static_cast<uint8_t *>(array.ArrayBuffer().Data()) + array.ByteOffset();
+    return {data, array.ByteLength()};
+  }
+
+  if (value.IsArrayBuffer()) {
+    auto buffer = value.As<Napi::ArrayBuffer>();
+    return {static_cast<uint8_t *>(buffer.Data()), buffer.ByteLength()};
+  }
+
+  return {};
+}
+
+// JS strings created for .NET string objects, per process and object address. A string whose UTF-16 payload did not
+// change since the last read is handed out again instead of creating a new one every tick.
+class StringCache {
+ public:
+  Napi::String get(Napi::Env env, void *process, uintptr_t address, const std::u16string &value) {
+    if (value.empty()) {
+      return Napi::String::New(env, "");
+    }
+
+    auto &strings = processes_[process];
+    auto it = strings.find(address);
+    if (it != strings.end() && it->second.value == value) {
+      return it->second.string.Value();
+    }
+
+    if (it == strings.end() && strings.size() >= max_strings) {
+      strings.clear();
+    }
+
+    auto string = Napi::String::New(env, value);
+    auto &entry = strings[address];
+    entry.value = value;
+    entry.string = Napi::Persistent(string);
+    return string;
+  }
+
+  void forget(void *process) {
+    processes_.erase(process);
+  }
+
+ private:
+  static constexpr std::size_t max_strings = 4096;
+
+  struct Entry {
+    std::u16string value;
+    Napi::Reference<Napi::String> string;
+  };
+
+  std::unordered_map<void *, std::unordered_map<uintptr_t, Entry>> processes_;
+};
+
+StringCache &string_cache() {
+  // Intentionally leaked, the references must not be released after the environment is torn down
+  static auto cache = new StringCache();
+  return *cache;
+}
+
+// Reads a .NET string through the cache, returns false if the string object could not be read.
+bool read_cached_string(Napi::Env env, void *handle, uintptr_t address, uint8_t pointer_size, Napi::Value &result) {
+  thread_local std::u16string value;
+  if (csharp_string::read(handle, address, pointer_size, value) != csharp_string::Status::ok) {
+    return false;
+  }
+
+  result = string_cache().get(env, handle, address, value);
+  return true;
+}
+
+// Packs decoded collection values, string typed ones are followed to their C# string.
+Napi::Value collection_values(
+  Napi::Env env,
+  void *handle,
+  const std::vector<double> &values,
+  struct_layout::FieldType type,
+  uint8_t pointer_size
+) {
+  if (type == struct_layout::FieldType::csharp_string) {
+    auto strings = Napi::Array::New(env, values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      Napi::Value string = Napi::String::New(env, "");
+      read_cached_string(env, handle, static_cast<uintptr_t>(values[i]), pointer_size, string);
+      strings.Set(i, string);
+    }
+    return strings;
+  }
+
+  auto array = Napi::Float64Array::New(env, values.size());
+  std::copy(values.begin(), values.end(), array.Data());
+  return array;
+}
+
+// Sampling thread of a watch and the JS callback its change batches go to. Queued deliveries only hold a weak
+// reference, so a batch that is still in flight when the watch is collected is dropped.
+struct Watch {
+  std::shared_ptr<watcher::Watcher> watcher;
+  Napi::ThreadSafeFunction callback;
+  bool stopped;
+
+  void stop() {
+    if (stopped) {
+      return;
+    }
+
+    stopped = true;
+    watcher->stop();
+    callback.Release();
+  }
+};
+
+Napi::Value watch_changes(Napi::Env env, const std::vector<watcher::Change> &changes) {
+  auto array = Napi::Array::New(env, changes.size());
+  for (size_t i = 0; i < changes.size(); i++) {
+    const auto &change = changes[i];
+
+    auto object = Napi::Object::New(env);
+    object.Set("id", Napi::Number::New(env, change.id));
+    object.Set("status", Napi::Number::New(env, static_cast<uint8_t>(change.status)));
+    object.Set("value", Napi::Number::New(env, change.value));
+    if (!change.data.empty()) {
+      object.Set("data", Napi::Buffer<uint8_t>::Copy(env, change.data.data(), change.data.size()));
+    }
+    array.Set(i, object);
+  }
+
+  return array;
+}
+
+// Sampler channel handed to JS, keeps the ring alive after the channel was removed from its sampler.
+struct SamplerChannel {
+  std::shared_ptr<sampler::Channel> channel;
+};
+
+Napi::Value sampler_channel(Napi::Env env, std::shared_ptr<sampler::Channel> channel) {
+  auto data = new SamplerChannel{std::move(channel)};
+  return Napi::External<SamplerChannel>::New(env, data, [](Napi::Env, SamplerChannel *data) {
+    delete data;
+  });
+}
+
+// Process watcher thread and the JS callback its events go to.
+struct ProcessWatch {
+  std::unique_ptr<process_watcher::Watcher> watcher;
+  Napi::ThreadSafeFunction callback;
+  bool stopped;
+
+  void stop() {
+    if (stopped) {
+      return;
+    }
+
+    stopped = true;
+    watcher->stop();
+    callback.Release();
+  }
+};
+
+Napi::Value process_events(Napi::Env env, const std::vector<process_watcher::Event> &events) {
+  auto array = Napi::Array::New(env, events.size());
+  for (size_t i = 0; i < events.size(); i++) {
+    const auto &process = events[i].process;
+
+    auto object = Napi::Object::New(env);
+    object.Set("type", Napi::String::New(env, events[i].attached ? "attach" : "detach"));
+    object.Set("pid", Napi::Number::New(env, process.pid));
+    object.Set("path", Napi::String::New(env, process.path));
+    object.Set("commandLine", Napi::String::New(env, process.command_line));
+    object.Set("cwd", Napi::String::New(env, process.cwd));
+    object.Set("is64bit", Napi::Boolean::New(env, process.is_64bit));
+    object.Set("startTime", Napi::Number::New(env, static_cast<double>(process.start_time)));
+    array.Set(i, object);
+  }
+
+  return array;
+}
+
+// Signature and mask bytes copied out of the JS pattern objects, so a scan can outlive the call that started it.
+struct PatternSet {
+  std::vector<std::vector<uint8_t>> bytes;
+  std::vector<Pattern> patterns;
+};
+
+std::shared_ptr<PatternSet> copy_patterns(Napi::Array pattern_array) {
+  auto set = std::make_shared<PatternSet>();
+  // The patterns point into `bytes`, which must not reallocate
+  set->bytes.reserve(pattern_array.Length() * 2);
+
+  for (uint32_t i = 0; i < pattern_array.Length(); i++) {
+    auto iter_obj = pattern_array.Get(i).As<Napi::Object>();
+    auto signature = iter_obj.Get("signature").As<Napi::Uint8Array>();
+    auto mask = iter_obj.Get("mask").As<Napi::Uint8Array>();
+
+    auto &signature_bytes = set->bytes.emplace_back(signature.Data(), signature.Data() + signature.ByteLength());
+    auto &mask_bytes = set->bytes.emplace_back(mask.Data(), mask.Data() + mask.ByteLength());
+
+    Pattern pattern;
+    pattern.index = i;
+    pattern.signature = signature_bytes;
+    pattern.mask = mask_bytes;
+    pattern.non_zero_mask = iter_obj.Get("nonZeroMask").As<Napi::Boolean>().Value();
+    pattern.found = false;
+    pattern.all = iter_obj.Has("all") && iter_obj.Get("all").ToBoolean().Value();
+
+    set->patterns.push_back(pattern);
+  }
+
+  return set;
+}
+
+Napi::Value pattern_results(Napi::Env env, const std::vector<PatternResult> &result) {
+  auto result_array = Napi::Array::New(env, result.size());
+
+  for (size_t i = 0; i < result.size(); i++) {
+    auto obj = Napi::Object::New(env);
+    obj.Set("index", Napi::Number::New(env, result[i].index));
+    obj.Set("address", Napi::Number::New(env, result[i].address));
+
+    result_array.Set(i, obj);
+  }
+
+  return result_array;
+}
+
+std::vector<uint8_t> copy_bytes(Napi::Uint8Array array) {
+  return std::vector<uint8_t>(array.Data(), array.Data() + array.ByteLength());
+}
+
+uint8_t parse_protection(const std::string &text) {
+  uint8_t protection = 0;
+  for (const auto c : text) {
+    protection |= c == 'r' ? MemoryRegion::read : c == 'w' ? MemoryRegion::write : c == 'x' ? MemoryRegion::execute : 0;
+  }
+  return protection;
+}
+
+std::string format_protection(uint8_t protection) {
+  auto text = std::string("---");
+  if (protection & MemoryRegion::read) {
+    text[0] = 'r';
+  }
+  if (protection & MemoryRegion::write) {
+    text[1] = 'w';
+  }
+  if (protection & MemoryRegion::execute) {
+    text[2] = 'x';
+  }
+  return text;
+}
+
+// Reads an optional JS RegionFilter, anything that is not an object selects the default regions.
+RegionFilter copy_filter(const Napi::CallbackInfo &args, size_t index) {
+  auto filter = RegionFilter();
+  if (args.Length() <= index || !args[index].IsObject()) {
+    return filter;
+  }
+
+  auto object = args[index].As<Napi::Object>();
+  if (object.Get("protection").IsString()) {
+    filter.protection = parse_protection(object.Get("protection").As<Napi::String>().Utf8Value());
+  }
+  if (object.Get("excludeProtection").IsString()) {
+    filter.excluded_protection = parse_protection(object.Get("excludeProtection").As<Napi::String>().Utf8Value());
+  }
+  if (object.Get("anonymous").IsBoolean()) {
+    filter.anonymous_only = object.Get("anonymous").As<Napi::Boolean>().Value();
+  }
+  if (object.Get("path").IsString()) {
+    filter.path = object.Get("path").As<Napi::String>().Utf8Value();
+  }
+  if (object.Get("start").IsNumber()) {
+    filter.start = static_cast<uintptr_t>(object.Get("start").As<Napi::Number>().Int64Value());
+  }
+  if (object.Get("end").IsNumber()) {
+    filter.end = static_cast<uintptr_t>(object.Get("end").As<Napi::Number>().Int64Value());
+  }
+  if (object.Get("skipUnpopulated").IsBoolean()) {
+    filter.skip_unpopulated = object.Get("skipUnpopulated").As<Napi::Boolean>().Value();
+  }
+  if (object.Get("residentOnly").IsBoolean()) {
+    filter.resident_only = object.Get("residentOnly").As<Napi::Boolean>().Value();
+  }
+
+  return filter;
+}
+
+// Runs `work` on the job queue as a job of `handle`. The promise resolves on the JS thread with `resolve(env, result)`,
+// or rejects if the job was cancelled before or while it ran. `keep_alive` stays referenced until then, for JS memory
+// the job writes into.
+template <class Result>
+Napi::Value run_job(
+  Napi::Env env,
+  void *handle,
+  std::function<Result(const std::atomic<bool> &)> work,
+  std::function<Napi::Value(Napi::Env, Result &)> resolve,
+  Napi::Object keep_alive = Napi::Object()
+) {
+  struct State {
+    Napi::Promise::Deferred deferred;
+    Napi::ObjectReference keep_alive;
+    std::function<Napi::Value(Napi::Env, Result &)> resolve;
+    Result result{};
+    bool cancelled = false;
+  };
+
+  auto deferred = Napi::Promise::Deferred::New(env);
+  auto reference = keep_alive.IsEmpty() ? Napi::ObjectReference() : Napi::Persistent(keep_alive);
+  auto state = std::make_shared<State>(State{deferred, std::move(reference), std::move(resolve)});
+
+  auto noop = Napi::Function::New(env, [](const Napi::CallbackInfo &) {});
+  auto tsfn = Napi::ThreadSafeFunction::New(env, noop, "job", 0, 1);
+
+  job_queue::submit(handle, [state, tsfn, work = std::move(work)](const std::atomic<bool> &cancelled) mutable {
+    if (!cancelled) {
+      state->result = work(cancelled);
+    }
+    state->cancelled = cancelled.load();
+
+    tsfn.BlockingCall([state](Napi::Env env, Napi::Function) {
+      if (state->cancelled) {
+        state->deferred.Reject(Napi::Error::New(env, "Job cancelled").Value());
+      } else {
+        state->deferred.Resolve(state->resolve(env, state->result));
+      }
+
+      // References must be released on the JS thread
+      state->keep_alive.Reset();
+    });
+    tsfn.Release();
+  });
+
+  return deferred.Promise();
+}
+
+// Success bitmap in front of the readBatch output, padded to 8 bytes so the data that follows stays aligned.
+std::size_t read_batch_bitmap_size(std::size_t count) {
+  return ((count + 63) / 64) * 8;
+}
+
+// Counterpart of the typed readers that never throws: a failed read returns 0 and leaves its memory::ReadStatus in
+// `status[0]`, so callers probing pointers that may be invalid branch on a byte instead of catching an error.
+template <class T>
+Napi::Value try_read(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 4) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto address = get_intptr_value(args[2], args[1]);
+  auto status = args[3].As<Napi::Uint8Array>();
+
+  T value{};
+  const auto result = memory::read_status(handle, address, value);
+  if (status.ElementLength() > 0) {
+    status[0] = static_cast<uint8_t>(result);
+  }
+
+  return Napi::Number::New(env, result == memory::ReadStatus::ok ? static_cast<double>(value) : 0);
+}
+
+// JS handler the native log records are forwarded to, empty while they go to stdout.
+Napi::ThreadSafeFunction log_callback;
+
+Napi::Value log_records(Napi::Env env, const std::vector<logger::Record> &records) {
+  auto array = Napi::Array::New(env, records.size());
+  for (size_t i = 0; i < records.size(); i++) {
+    auto object = Napi::Object::New(env);
+    object.Set("level", Napi::Number::New(env, static_cast<uint8_t>(records[i].level)));
+    object.Set("message", Napi::String::New(env, records[i].message));
+    object.Set("suppressed", Napi::Number::New(env, records[i].suppressed));
+    array.Set(i, object);
+  }
+
+  return array;
+}
+
 }  // namespace
 
 Napi::Value read_byte(const Napi::CallbackInfo &args) {
@@ -165,7 +568,7 @@ Napi::Value scan_sync(const Napi::CallbackInfo &args) {
   auto mask = std::vector<uint8_t>(mask_buffer.ByteLength());
   memcpy(mask.data(), mask_buffer.Data(), mask_buffer.ByteLength());
 
-  auto result = memory::find_pattern(handle, signature, mask, non_zero_mask);
+  auto result = memory::find_pattern(handle, signature, mask, non_zero_mask, nullptr, copy_filter(args, 4));
 
   if (!result) {
     Napi::TypeError::New(env, "Couldn't find signature").ThrowAsJavaScriptException();
@@ -186,37 +589,47 @@ Napi::Value batch_scan(const Napi::CallbackInfo &args) {
   auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
   auto pattern_array = args[1].As<Napi::Array>();
 
-  std::vector<Pattern> patterns;
+  auto set = copy_patterns(pattern_array);
 
-  for (size_t i = 0; i < pattern_array.Length(); i++) {
-    Pattern pattern;
+  auto cache_path = std::string();
+  if (args.Length() > 2 && args[2].IsString()) {
+    cache_path = args[2].As<Napi::String>().Utf8Value();
+  }
 
-    auto iter_obj = pattern_array.Get(i).As<Napi::Object>();
-    auto signature = iter_obj.Get("signature").As<Napi::Uint8Array>();
-    auto mask = iter_obj.Get("mask").As<Napi::Uint8Array>();
-    auto non_zero_mask = iter_obj.Get("nonZeroMask").As<Napi::Boolean>().Value();
+  auto filter = copy_filter(args, 3);
+  auto result = cache_path.empty() ? memory::batch_find_pattern(handle, set->patterns, nullptr, filter)
+                                   : scan_cache::batch_find_pattern(handle, set->patterns, cache_path, nullptr, filter);
 
-    pattern.index = i;
-    pattern.signature = std::span<uint8_t>(reinterpret_cast<uint8_t *>(signature.Data()), signature.ByteLength());
-    pattern.mask = std::span<uint8_t>(reinterpret_cast<uint8_t *>(mask.Data()), mask.ByteLength());
-    pattern.non_zero_mask = non_zero_mask;
-    pattern.found = false;
+  return pattern_results(env, result);
+}
 
-    patterns.push_back(pattern);
+Napi::Value batch_scan_async(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 2) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  auto result = memory::batch_find_pattern(handle, patterns);
-  auto result_array = Napi::Array::New(env, result.size());
-
-  for (size_t i = 0; i < result.size(); i++) {
-    auto obj = Napi::Object::New(env);
-    obj.Set("index", Napi::Number::New(env, result[i].index));
-    obj.Set("address", Napi::Number::New(env, result[i].address));
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto set = copy_patterns(args[1].As<Napi::Array>());
 
-    result_array.Set(i, obj);
+  auto cache_path = std::string();
+  if (args.Length() > 2 && args[2].IsString()) {
+    cache_path = args[2].As<Napi::String>().Utf8Value();
   }
 
-  return result_array;
+  auto filter = copy_filter(args, 3);
+
+  return run_job<std::vector<PatternResult>>(
+    env,
+    handle,
+    [handle, set, cache_path, filter](const std::atomic<bool> &cancelled) {
+      return cache_path.empty()
+               ? memory::batch_find_pattern(handle, set->patterns, &cancelled, filter)
+               : scan_cache::batch_find_pattern(handle, set->patterns, cache_path, &cancelled, filter);
+    },
+    pattern_results
+  );
 }
 
 Napi::Value read_buffer(const Napi::CallbackInfo &args) {
@@ -229,206 +642,1170 @@ Napi::Value read_buffer(const Napi::CallbackInfo &args) {
   auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
   auto address = get_intptr_value(args[2], args[1]);
   auto size = args[3].As<Napi::Number>().Uint32Value();
-  auto buffer = new uint8_t[size];
-  auto data = (uint8_t *)malloc(sizeof(uint8_t) * size);
-  auto result = memory::read_buffer(handle, address, size, data);
 
-  if (!result) {
-    free(data);
-    delete[] buffer;
+  auto out = Napi::Buffer<uint8_t>::New(env, size);
+  if (!memory::read_buffer(handle, address, size, out.Data())) {
     Napi::TypeError::New(env, std::format("Couldn't read buffer at {:x}", address)).ThrowAsJavaScriptException();
-
     return env.Null();
   }
 
-  auto out = Napi::Buffer<uint8_t>::Copy(env, data, size);
-  free(data);
-  delete[] buffer;
-
   return out;
 }
 
-static bool scanning = false;
-
-Napi::Value scan(const Napi::CallbackInfo &args) {
+Napi::Value read_into(const Napi::CallbackInfo &args) {
   Napi::Env env = args.Env();
-  if (args.Length() < 5) {
+  if (args.Length() < 6) {
     Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
     return env.Null();
   }
 
   auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
-  auto signature = args[1].As<Napi::Uint8Array>();
-  auto mask = args[2].As<Napi::Uint8Array>();
-  auto callback = Napi::ThreadSafeFunction::New(args.Env(), args[3].As<Napi::Function>(), "tsfn", 0, 1);
-  auto non_zero_mask = args[4].As<Napi::Boolean>().Value();
-
-  auto signature_data = signature.Data();
-  auto signature_length = signature.ByteLength();
-  auto mask_data = mask.Data();
-  auto mask_length = mask.ByteLength();
-
-  if (!scanning) {
-    scanning = true;
+  auto address = get_intptr_value(args[2], args[1]);
+  auto offset = static_cast<size_t>(args[4].As<Napi::Number>().Int64Value());
+  auto length = static_cast<size_t>(args[5].As<Napi::Number>().Int64Value());
 
-    std::thread(
-      [handle, signature_data, signature_length, mask_data, mask_length, non_zero_mask](Napi::ThreadSafeFunction tsfn) {
-        auto signature = std::vector<uint8_t>(signature_length);
-        memcpy(signature.data(), signature_data, signature_length);
+  auto target = view_bytes(args[3]);
+  if (target.empty() && !args[3].IsTypedArray() && !args[3].IsArrayBuffer()) {
+    Napi::TypeError::New(env, "Target has to be an ArrayBuffer or a TypedArray").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-        auto mask = std::vector<uint8_t>(mask_length);
-        memcpy(mask.data(), mask_data, mask_length);
+  if (offset > target.size() || length > target.size() - offset) {
+    Napi::TypeError::New(env, std::format("Read of {} bytes at {} overflows the target", length, offset))
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-        const auto result = memory::find_pattern(handle, signature, mask, non_zero_mask);
-        scanning = false;
-        tsfn.BlockingCall([result, tsfn](Napi::Env env, Napi::Function jsCallback) {
-          jsCallback.Call({Napi::Number::From(env, result)});
-          tsfn.Release();
-        });
-      },
-      callback
-    )
-      .detach();
+  if (!memory::read_buffer(handle, address, length, target.data() + offset)) {
+    Napi::TypeError::New(env, std::format("Couldn't read buffer at {:x}", address)).ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  return env.Undefined();
+  return Napi::Number::New(env, static_cast<double>(length));
 }
 
-Napi::Value scan_all(const Napi::CallbackInfo &args) {
+Napi::Value try_read_into(const Napi::CallbackInfo &args) {
   Napi::Env env = args.Env();
-  if (args.Length() < 4) {
+  if (args.Length() < 6) {
     Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
     return env.Null();
   }
 
   auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
-  auto signature_buffer = args[1].As<Napi::Uint8Array>();
-  auto mask_buffer = args[2].As<Napi::Uint8Array>();
-  auto non_zero_mask = args[3].As<Napi::Boolean>().Value();
-
-  auto signature = std::vector<uint8_t>(signature_buffer.ByteLength());
-  memcpy(signature.data(), signature_buffer.Data(), signature_buffer.ByteLength());
-
-  auto mask = std::vector<uint8_t>(mask_buffer.ByteLength());
-  memcpy(mask.data(), mask_buffer.Data(), mask_buffer.ByteLength());
+  auto address = get_intptr_value(args[2], args[1]);
+  auto offset = static_cast<size_t>(args[4].As<Napi::Number>().Int64Value());
+  auto length = static_cast<size_t>(args[5].As<Napi::Number>().Int64Value());
 
-  const auto results = memory::find_pattern_all(handle, signature, mask, non_zero_mask);
+  // Bad arguments are programming errors and still throw, only the read itself reports a status
+  auto target = view_bytes(args[3]);
+  if (target.empty() && !args[3].IsTypedArray() && !args[3].IsArrayBuffer()) {
+    Napi::TypeError::New(env, "Target has to be an ArrayBuffer or a TypedArray").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  auto result_array = Napi::Array::New(env, results.size());
-  for (size_t i = 0; i < results.size(); i++) {
-    result_array.Set(i, Napi::Number::New(env, static_cast<double>(results[i])));
+  if (offset > target.size() || length > target.size() - offset) {
+    Napi::TypeError::New(env, std::format("Read of {} bytes at {} overflows the target", length, offset))
+      .ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  return result_array;
+  const auto status = memory::read_buffer_status(handle, address, length, target.data() + offset);
+  return Napi::Number::New(env, static_cast<uint8_t>(status));
 }
 
-Napi::Value find_processes(const Napi::CallbackInfo &args) {
+Napi::Value read_ptr_array(const Napi::CallbackInfo &args) {
   Napi::Env env = args.Env();
-  if (args.Length() < 1) {
+  if (args.Length() < 5) {
     Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  Napi::Array process_array = args[0].As<Napi::Array>();
-  std::vector<std::string> process_names;
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto bitness = args[1].As<Napi::Number>().Int32Value();
+  auto address = get_intptr_value(args[2], args[1]);
+  auto target = args[3].As<Napi::Float64Array>();
+  auto count = static_cast<size_t>(args[4].As<Napi::Number>().Int64Value());
 
-  for (size_t i = 0; i < process_array.Length(); i++) {
-    Napi::Value value = process_array[i];
-    if (value.IsString()) {
-      std::string name = value.As<Napi::String>().Utf8Value();
-      process_names.push_back(name);
-    }
+  if (count > target.ElementLength()) {
+    Napi::TypeError::New(env, std::format("Target holds less than {} pointers", count)).ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  auto processes = memory::find_processes(process_names);
+  const auto pointer_size = bitness == 64 ? sizeof(uint64_t) : sizeof(uint32_t);
 
-  auto arr = Napi::Array::New(env, processes.size());
-  for (size_t i = 0; i < processes.size(); i++) {
-    arr.Set(i, processes[i]);
+  // Pointers are read into the tail of the target and widened front to back, so no scratch buffer is needed
+  auto raw = reinterpret_cast<uint8_t *>(target.Data()) + count * (sizeof(double) - pointer_size);
+  if (!memory::read_buffer(handle, address, count * pointer_size, raw)) {
+    Napi::TypeError::New(env, std::format("Couldn't read pointers at {:x}", address)).ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  return arr;
-}
-
-Napi::Value open_process(const Napi::CallbackInfo &args) {
-  Napi::Env env = args.Env();
-  if (args.Length() < 1) {
-    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
-    return env.Null();
+  for (size_t i = 0; i < count; i++) {
+    if (pointer_size == sizeof(uint64_t)) {
+      uint64_t value;
+      std::memcpy(&value, raw + i * pointer_size, sizeof(value));
+      target[i] = static_cast<double>(value);
+    } else {
+      uint32_t value;
+      std::memcpy(&value, raw + i * pointer_size, sizeof(value));
+      target[i] = static_cast<double>(value);
+    }
   }
 
-  auto process_id = args[0].As<Napi::Number>().Int64Value();
-  return Napi::Number::New(env, reinterpret_cast<uint64_t>(memory::open_process(process_id)));
+  return Napi::Number::New(env, static_cast<double>(count));
 }
 
-Napi::Value close_handle(const Napi::CallbackInfo &args) {
+Napi::Value read_batch(const Napi::CallbackInfo &args) {
   Napi::Env env = args.Env();
-  if (args.Length() < 1) {
+  if (args.Length() < 3) {
     Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
     return env.Null();
   }
 
   auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto request_array = args[1].As<Napi::Float64Array>();
+  auto output = args[2].As<Napi::Uint8Array>();
 
-  memory::close_handle(handle);
+  thread_local std::vector<ReadRequest> requests;
 
-  return env.Undefined();
-}
+  const auto count = request_array.ElementLength() / 2;
+  requests.resize(count);
 
-Napi::Value is_process_exist(const Napi::CallbackInfo &args) {
-  Napi::Env env = args.Env();
-  if (args.Length() < 1) {
-    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+  std::size_t data_size = 0;
+  for (size_t i = 0; i < count; i++) {
+    requests[i].address = static_cast<uintptr_t>(request_array[i * 2]);
+    requests[i].size = static_cast<std::size_t>(request_array[i * 2 + 1]);
+    data_size += requests[i].size;
+  }
+
+  const auto bitmap_size = read_batch_bitmap_size(count);
+  if (output.ByteLength() < bitmap_size + data_size) {
+    Napi::TypeError::New(env, std::format("Batch output needs {} bytes", bitmap_size + data_size))
+      .ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
-  return Napi::Boolean::New(env, memory::is_process_exist(handle));
-}
+  const auto succeeded = memory::read_batch(handle, requests, output.Data() + bitmap_size, output.Data());
 
-Napi::Value is_process_64bit(const Napi::CallbackInfo &args) {
-  Napi::Env env = args.Env();
-  if (args.Length() < 1) {
-    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
-    return env.Null();
+  // With a status array every failed request is classified, which costs a lookup per failure only
+  if (args.Length() > 3 && args[3].IsTypedArray()) {
+    auto statuses = args[3].As<Napi::Uint8Array>();
+    for (size_t i = 0; i < count && i < statuses.ElementLength(); i++) {
+      const auto read = (output.Data()[i / 8] >> (i % 8)) & 1;
+      statuses[i] = static_cast<uint8_t>(
+        read ? memory::ReadStatus::ok : memory::unreadable_status(handle, requests[i].address, requests[i].size)
+      );
+    }
   }
 
-  auto process_id = args[0].As<Napi::Number>().Int64Value();
-  return Napi::Boolean::New(env, memory::is_process_64bit(process_id));
+  return Napi::Number::New(env, static_cast<double>(succeeded));
 }
 
-Napi::Value get_process_start_time(const Napi::CallbackInfo &args) {
+Napi::Value read_batch_async(const Napi::CallbackInfo &args) {
   Napi::Env env = args.Env();
-  if (args.Length() < 1) {
+  if (args.Length() < 3) {
     Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
     return env.Null();
   }
 
   auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
-  return Napi::Number::New(env, static_cast<double>(memory::get_process_start_time(handle)));
-}
+  auto request_array = args[1].As<Napi::Float64Array>();
+  auto output = args[2].As<Napi::Uint8Array>();
 
-Napi::Value get_process_path(const Napi::CallbackInfo &args) {
-  Napi::Env env = args.Env();
-  if (args.Length() < 1) {
-    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+  const auto count = request_array.ElementLength() / 2;
+  auto requests = std::make_shared<std::vector<ReadRequest>>(count);
+
+  std::size_t data_size = 0;
+  for (size_t i = 0; i < count; i++) {
+    (*requests)[i].address = static_cast<uintptr_t>(request_array[i * 2]);
+    (*requests)[i].size = static_cast<std::size_t>(request_array[i * 2 + 1]);
+    data_size += (*requests)[i].size;
+  }
+
+  const auto bitmap_size = read_batch_bitmap_size(count);
+  if (output.ByteLength() < bitmap_size + data_size) {
+    Napi::TypeError::New(env, std::format("Batch output needs {} bytes", bitmap_size + data_size))
+      .ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
-  return Napi::String::From(env, memory::get_process_path(handle));
+  auto data = output.Data();
+  return run_job<std::size_t>(
+    env,
+    handle,
+    [handle, requests, data, bitmap_size](const std::atomic<bool> &) {
+      return memory::read_batch(handle, *requests, data + bitmap_size, data);
+    },
+    [](Napi::Env env, std::size_t &succeeded) -> Napi::Value {
+      return Napi::Number::New(env, static_cast<double>(succeeded));
+    },
+    output
+  );
 }
 
-Napi::Value get_process_command_line(const Napi::CallbackInfo &args) {
+Napi::Value compile_chain(const Napi::CallbackInfo &args) {
   Napi::Env env = args.Env();
-  if (args.Length() < 1) {
+  if (args.Length() < 4) {
     Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto base = static_cast<uintptr_t>(args[0].As<Napi::Number>().Int64Value());
+  auto offset_array = args[1].As<Napi::Array>();
+  auto type = args[2].As<Napi::Number>().Uint32Value();
+  auto bitness = args[3].As<Napi::Number>().Int32Value();
 
-  auto command_line = memory::get_process_command_line(handle);
+  if (type > static_cast<uint32_t>(pointer_chain::ValueType::pointer)) {
+    Napi::TypeError::New(env, std::format("Unknown chain value type {}", type)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto offsets = std::vector<int64_t>(offset_array.Length());
+  for (size_t i = 0; i < offsets.size(); i++) {
+    offsets[i] = offset_array.Get(i).As<Napi::Number>().Int64Value();
+  }
+
+  auto program = new pointer_chain::Program(
+    pointer_chain::compile(base, std::move(offsets), static_cast<pointer_chain::ValueType>(type), bitness)
+  );
+
+  return Napi::External<pointer_chain::Program>::New(env, program, [](Napi::Env, pointer_chain::Program *data) {
+    delete data;
+  });
+}
+
+Napi::Value evaluate_chains(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 4) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto program_array = args[1].As<Napi::Array>();
+  auto values = args[2].As<Napi::Float64Array>();
+  auto statuses = args[3].As<Napi::Uint8Array>();
+
+  const auto count = program_array.Length();
+  if (values.ElementLength() < count || statuses.ElementLength() < count) {
+    Napi::TypeError::New(env, std::format("Chain output needs {} elements", count)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  thread_local std::vector<const pointer_chain::Program *> programs;
+  thread_local std::vector<pointer_chain::Result> results;
+
+  programs.resize(count);
+  results.resize(count);
+  for (uint32_t i = 0; i < count; i++) {
+    programs[i] = program_array.Get(i).As<Napi::External<pointer_chain::Program>>().Data();
+  }
+
+  const auto resolved = pointer_chain::evaluate(handle, programs, results);
+
+  for (uint32_t i = 0; i < count; i++) {
+    values[i] = results[i].value;
+    statuses[i] = static_cast<uint8_t>(results[i].status);
+  }
+
+  return Napi::Number::New(env, static_cast<double>(resolved));
+}
+
+Napi::Value compile_struct(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 2) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto field_array = args[0].As<Napi::Array>();
+  auto bitness = args[1].As<Napi::Number>().Int32Value();
+
+  auto schema = std::make_unique<StructSchema>();
+  auto fields = std::vector<struct_layout::Field>();
+
+  for (uint32_t i = 0; i < field_array.Length(); i++) {
+    auto field = field_array.Get(i).As<Napi::Object>();
+    auto name = field.Get("name");
+    auto offset = field.Get("offset");
+    auto type = field.Get("type").As<Napi::Number>().Uint32Value();
+
+    if (!name.IsString() || !offset.IsNumber()) {
+      Napi::TypeError::New(env, std::format("Struct field {} needs a name and an offset", i)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    if (type > static_cast<uint32_t>(struct_layout::FieldType::csharp_string)) {
+      Napi::TypeError::New(env, std::format("Unknown struct field type {}", type)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    fields.push_back(
+      struct_layout::Field{offset.As<Napi::Number>().Uint32Value(), static_cast<struct_layout::FieldType>(type)}
+    );
+    schema->names.push_back(Napi::Persistent(name.As<Napi::String>()));
+  }
+
+  schema->layout = struct_layout::compile(std::move(fields), bitness);
+
+  return Napi::External<StructSchema>::New(env, schema.release(), [](Napi::Env, StructSchema *data) {
+    delete data;
+  });
+}
+
+Napi::Value read_struct(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 3) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto schema = args[1].As<Napi::External<StructSchema>>().Data();
+  auto address = static_cast<uintptr_t>(args[2].As<Napi::Number>().Int64Value());
+  auto target = args.Length() > 3 && args[3].IsObject() ? args[3].As<Napi::Object>() : Napi::Object::New(env);
+
+  thread_local std::vector<uint8_t> buffer;
+  if (address == 0 || !struct_layout::read_span(handle, schema->layout, address, buffer)) {
+    return env.Null();
+  }
+
+  const auto &layout = schema->layout;
+  for (size_t i = 0; i < layout.fields.size(); i++) {
+    const auto &field = layout.fields[i];
+    const auto value = struct_layout::decode(layout, field, buffer);
+
+    if (field.type == struct_layout::FieldType::csharp_string) {
+      Napi::Value string = Napi::String::New(env, "");
+      read_cached_string(env, handle, static_cast<uintptr_t>(value), layout.pointer_size, string);
+      target.Set(schema->names[i].Value(), string);
+    } else {
+      target.Set(schema->names[i].Value(), Napi::Number::New(env, value));
+    }
+  }
+
+  return target;
+}
+
+Napi::Value read_struct_values(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 4) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto schema = args[1].As<Napi::External<StructSchema>>().Data();
+  auto address = static_cast<uintptr_t>(args[2].As<Napi::Number>().Int64Value());
+  auto values = args[3].As<Napi::Float64Array>();
+
+  const auto &layout = schema->layout;
+  if (values.ElementLength() < layout.fields.size()) {
+    Napi::TypeError::New(env, std::format("Struct output needs {} elements", layout.fields.size()))
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  thread_local std::vector<uint8_t> buffer;
+  if (address == 0 || !struct_layout::read_span(handle, layout, address, buffer)) {
+    return Napi::Boolean::New(env, false);
+  }
+
+  // Strings are left as their pointer, numbers go straight into the view
+  for (size_t i = 0; i < layout.fields.size(); i++) {
+    values[i] = struct_layout::decode(layout, layout.fields[i], buffer);
+  }
+
+  return Napi::Boolean::New(env, true);
+}
+
+Napi::Value read_sharp_list(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 3) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto bitness = args[1].As<Napi::Number>().Int32Value();
+  auto address = get_intptr_value(args[2], args[1]);
+
+  thread_local std::vector<double> items;
+  if (!collections::read_list(handle, static_cast<uintptr_t>(address), bitness == 64 ? 8 : 4, items)) {
+    Napi::TypeError::New(env, std::format("Couldn't read list at {:x}", address)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto result = Napi::Float64Array::New(env, items.size());
+  std::copy(items.begin(), items.end(), result.Data());
+  return result;
+}
+
+Napi::Value read_sharp_dictionary(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 4) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto bitness = args[1].As<Napi::Number>().Int32Value();
+  auto address = get_intptr_value(args[2], args[1]);
+  auto layout_array = args[3].As<Napi::Array>();
+
+  if (layout_array.Length() < 9) {
+    Napi::TypeError::New(env, "Dictionary layout needs 9 values").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const auto layout_value = [&layout_array](uint32_t index) {
+    return layout_array.Get(index).As<Napi::Number>().Int32Value();
+  };
+
+  const auto key_type = static_cast<uint32_t>(layout_value(6));
+  const auto value_type = static_cast<uint32_t>(layout_value(8));
+  if (key_type > static_cast<uint32_t>(struct_layout::FieldType::csharp_string) ||
+      value_type > static_cast<uint32_t>(struct_layout::FieldType::csharp_string)) {
+    Napi::TypeError::New(env, "Unknown dictionary key or value type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const auto layout = collections::DictionaryLayout{
+    static_cast<uint32_t>(layout_value(0)),
+    static_cast<uint32_t>(layout_value(1)),
+    static_cast<uint32_t>(layout_value(2)),
+    layout_value(3),
+    layout_value(4),
+    {static_cast<uint32_t>(layout_value(5)), static_cast<struct_layout::FieldType>(key_type)},
+    {static_cast<uint32_t>(layout_value(7)), static_cast<struct_layout::FieldType>(value_type)},
+  };
+  const auto pointer_size = static_cast<uint8_t>(bitness == 64 ? 8 : 4);
+
+  thread_local collections::DictionaryEntries entries;
+  if (!collections::read_dictionary(handle, static_cast<uintptr_t>(address), layout, pointer_size, entries)) {
+    Napi::TypeError::New(env, std::format("Couldn't read dictionary at {:x}", address)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto indices = Napi::Uint32Array::New(env, entries.indices.size());
+  std::copy(entries.indices.begin(), entries.indices.end(), indices.Data());
+
+  auto result = Napi::Object::New(env);
+  result.Set("indices", indices);
+  result.Set("keys", collection_values(env, handle, entries.keys, layout.key.type, pointer_size));
+  result.Set("values", collection_values(env, handle, entries.values, layout.value.type, pointer_size));
+  return result;
+}
+
+Napi::Value create_watch(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 3) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto interval = std::chrono::milliseconds(args[1].As<Napi::Number>().Int64Value());
+  auto callback = Napi::ThreadSafeFunction::New(env, args[2].As<Napi::Function>(), "watch", 0, 1);
+
+  // Filled in once the watcher exists, the notification only runs after start()
+  auto target = std::make_shared<std::weak_ptr<watcher::Watcher>>();
+
+  auto notify = [callback, target]() mutable {
+    callback.NonBlockingCall([target](Napi::Env env, Napi::Function js_callback) {
+      auto watcher = target->lock();
+      if (!watcher) {
+        return;
+      }
+
+      thread_local std::vector<watcher::Change> changes;
+      watcher->take_changes(changes);
+      if (!changes.empty()) {
+        js_callback.Call({watch_changes(env, changes)});
+      }
+    });
+  };
+
+  auto watch = new Watch{std::make_shared<watcher::Watcher>(handle, interval, std::move(notify)), callback, false};
+  *target = watch->watcher;
+  watch->watcher->start();
+
+  return Napi::External<Watch>::New(env, watch, [](Napi::Env, Watch *data) {
+    data->stop();
+    delete data;
+  });
+}
+
+Napi::Value watch_range(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 4) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto watch = args[0].As<Napi::External<Watch>>().Data();
+  auto address = get_intptr_value(args[1], args[3]);
+  auto size = static_cast<std::size_t>(args[2].As<Napi::Number>().Int64Value());
+
+  if (size == 0 || size > watcher::max_range_size) {
+    Napi::TypeError::New(env, std::format("Watched range size must be within 1..{}", watcher::max_range_size))
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Number::New(env, watch->watcher->watch_range(address, size));
+}
+
+Napi::Value watch_chain(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 2) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto watch = args[0].As<Napi::External<Watch>>().Data();
+  auto program = args[1].As<Napi::External<pointer_chain::Program>>().Data();
+
+  return Napi::Number::New(env, watch->watcher->watch_chain(*program));
+}
+
+Napi::Value unwatch(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 2) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto watch = args[0].As<Napi::External<Watch>>().Data();
+  auto id = args[1].As<Napi::Number>().Uint32Value();
+
+  return Napi::Boolean::New(env, watch->watcher->unwatch(id));
+}
+
+Napi::Value set_watch_soft_dirty(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 2) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto watch = args[0].As<Napi::External<Watch>>().Data();
+  auto enabled = args[1].As<Napi::Boolean>().Value();
+
+  return Napi::Boolean::New(env, watch->watcher->set_soft_dirty(enabled));
+}
+
+Napi::Value get_watch_stats(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const auto stats = args[0].As<Napi::External<Watch>>().Data()->watcher->stats();
+
+  auto object = Napi::Object::New(env);
+  object.Set("bytesRead", Napi::Number::New(env, static_cast<double>(stats.bytes_read)));
+  object.Set("bytesSkipped", Napi::Number::New(env, static_cast<double>(stats.bytes_skipped)));
+  object.Set("softDirty", Napi::Boolean::New(env, stats.soft_dirty));
+  return object;
+}
+
+Napi::Value set_watch_interval(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 2) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto watch = args[0].As<Napi::External<Watch>>().Data();
+  auto interval = std::chrono::milliseconds(args[1].As<Napi::Number>().Int64Value());
+
+  watch->watcher->set_interval(interval);
+
+  return env.Undefined();
+}
+
+Napi::Value stop_watch(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  args[0].As<Napi::External<Watch>>().Data()->stop();
+
+  return env.Undefined();
+}
+
+Napi::Value create_sampler(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 2) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto interval = std::chrono::microseconds(static_cast<int64_t>(args[1].As<Napi::Number>().DoubleValue() * 1000));
+
+  auto instance = new sampler::Sampler(handle, interval);
+  instance->start();
+
+  return Napi::External<sampler::Sampler>::New(env, instance, [](Napi::Env, sampler::Sampler *data) {
+    delete data;
+  });
+}
+
+Napi::Value sampler_tail(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 8) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto instance = args[0].As<Napi::External<sampler::Sampler>>().Data();
+  auto items = args[1].As<Napi::External<pointer_chain::Program>>().Data();
+  auto size = args[2].As<Napi::External<pointer_chain::Program>>().Data();
+  auto header = args[3].As<Napi::Number>().Uint32Value();
+  auto element = args[4].As<Napi::Number>().Uint32Value();
+  auto min = args[5].As<Napi::Number>().DoubleValue();
+  auto max = args[6].As<Napi::Number>().DoubleValue();
+  auto capacity = args[7].As<Napi::Number>().Uint32Value();
+
+  if (element >= static_cast<uint32_t>(struct_layout::FieldType::csharp_string)) {
+    Napi::TypeError::New(env, std::format("Unsupported tail element type {}", element)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto tail = sampler::Tail{*items, *size, header, static_cast<struct_layout::FieldType>(element), min, max};
+  return sampler_channel(env, instance->add_tail(std::move(tail), capacity));
+}
+
+Napi::Value sampler_snapshot(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 3) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto instance = args[0].As<Napi::External<sampler::Sampler>>().Data();
+  auto program_array = args[1].As<Napi::Array>();
+  auto capacity = args[2].As<Napi::Number>().Uint32Value();
+
+  if (program_array.Length() == 0) {
+    Napi::TypeError::New(env, "Snapshot needs at least one chain").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto programs = std::vector<pointer_chain::Program>();
+  programs.reserve(program_array.Length());
+  for (uint32_t i = 0; i < program_array.Length(); i++) {
+    programs.push_back(*program_array.Get(i).As<Napi::External<pointer_chain::Program>>().Data());
+  }
+
+  return sampler_channel(env, instance->add_snapshot(std::move(programs), capacity));
+}
+
+Napi::Value drain_sampler(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto &channel = *args[0].As<Napi::External<SamplerChannel>>().Data()->channel;
+
+  thread_local std::vector<double> values;
+  values.clear();
+  channel.ring.drain(values);
+
+  auto array = Napi::Float64Array::New(env, values.size());
+  std::copy(values.begin(), values.end(), array.Data());
+  return array;
+}
+
+Napi::Value remove_sampler_channel(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 2) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto instance = args[0].As<Napi::External<sampler::Sampler>>().Data();
+  auto channel = args[1].As<Napi::External<SamplerChannel>>().Data();
+
+  instance->remove(channel->channel.get());
+
+  return env.Undefined();
+}
+
+Napi::Value set_sampler_interval(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 2) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto instance = args[0].As<Napi::External<sampler::Sampler>>().Data();
+  auto interval = std::chrono::microseconds(static_cast<int64_t>(args[1].As<Napi::Number>().DoubleValue() * 1000));
+
+  instance->set_interval(interval);
+
+  return env.Undefined();
+}
+
+Napi::Value stop_sampler(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  args[0].As<Napi::External<sampler::Sampler>>().Data()->stop();
+
+  return env.Undefined();
+}
+
+Napi::Value get_regions(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto filter = copy_filter(args, 1);
+  // Unlike scans, listing regions shows everything unless asked otherwise
+  if (args.Length() < 2 || !args[1].IsObject() || !args[1].As<Napi::Object>().Get("protection").IsString()) {
+    filter.protection = MemoryRegion::read;
+  }
+
+  const auto table = memory::query_regions(handle);
+  const auto regions = memory::filter_regions(*table, filter);
+
+  auto result_array = Napi::Array::New(env, regions.size());
+  for (size_t i = 0; i < regions.size(); i++) {
+    const auto &region = regions[i];
+
+    auto object = Napi::Object::New(env);
+    object.Set("address", Napi::Number::New(env, static_cast<double>(region.address)));
+    object.Set("size", Napi::Number::New(env, static_cast<double>(region.size)));
+    object.Set("protection", Napi::String::New(env, format_protection(region.protection)));
+    object.Set("shared", Napi::Boolean::New(env, region.shared));
+    object.Set("anonymous", Napi::Boolean::New(env, region.anonymous));
+    object.Set("offset", Napi::Number::New(env, static_cast<double>(region.offset)));
+    object.Set("inode", Napi::Number::New(env, static_cast<double>(region.inode)));
+    object.Set("path", Napi::String::New(env, region.path.data(), region.path.size()));
+    result_array.Set(i, object);
+  }
+
+  return result_array;
+}
+
+Napi::Value get_stats(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  const auto snapshot = stats::snapshot(handle);
+
+  auto result = Napi::Object::New(env);
+  for (size_t i = 0; i < stats::operation_count; i++) {
+    const auto &operation = snapshot.operations[i];
+
+    auto latency = Napi::Array::New(env, stats::latency_buckets);
+    for (size_t bucket = 0; bucket < stats::latency_buckets; bucket++) {
+      latency.Set(bucket, Napi::Number::New(env, static_cast<double>(operation.latency[bucket])));
+    }
+
+    auto object = Napi::Object::New(env);
+    object.Set("calls", Napi::Number::New(env, static_cast<double>(operation.calls)));
+    object.Set("failures", Napi::Number::New(env, static_cast<double>(operation.failures)));
+    object.Set("bytes", Napi::Number::New(env, static_cast<double>(operation.bytes)));
+    object.Set("syscalls", Napi::Number::New(env, static_cast<double>(operation.syscalls)));
+    object.Set("totalNs", Napi::Number::New(env, static_cast<double>(operation.total_ns)));
+    object.Set("p50Ns", Napi::Number::New(env, static_cast<double>(stats::latency_quantile(operation, 0.5))));
+    object.Set("p99Ns", Napi::Number::New(env, static_cast<double>(stats::latency_quantile(operation, 0.99))));
+    object.Set("latency", latency);
+
+    const auto name = stats::operation_name(static_cast<stats::Operation>(i));
+    result.Set(std::string(name), object);
+  }
+
+  auto scan = Napi::Object::New(env);
+  scan.Set("bytesScanned", Napi::Number::New(env, static_cast<double>(snapshot.scan.bytes_scanned)));
+  scan.Set("bytesSkipped", Napi::Number::New(env, static_cast<double>(snapshot.scan.bytes_skipped)));
+  result.Set("scan", scan);
+
+  return result;
+}
+
+Napi::Value reset_stats(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  stats::reset(handle);
+  return env.Undefined();
+}
+
+Napi::Value start_trace(const Napi::CallbackInfo &args) {
+  const auto capacity = args.Length() < 1 || !args[0].IsNumber() ? TSPROCESS_TRACE_CAPACITY
+                                                                  : args[0].As<Napi::Number>().Int64Value();
+  tracer::start(static_cast<std::size_t>(std::max<int64_t>(capacity, 1)));
+  return args.Env().Undefined();
+}
+
+Napi::Value stop_trace(const Napi::CallbackInfo &args) {
+  tracer::stop();
+  return args.Env().Undefined();
+}
+
+Napi::Value dump_trace(const Napi::CallbackInfo &args) {
+  return Napi::String::New(args.Env(), tracer::dump());
+}
+
+Napi::Value set_log_handler(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 2) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto level = args[1].As<Napi::Number>().Uint32Value();
+  if (level > static_cast<uint32_t>(logger::Level::error)) {
+    Napi::TypeError::New(env, "Unknown log level").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Records queued so far still go to the previous handler, once the sink is replaced the logger thread no longer
+  // holds it
+  logger::flush();
+  logger::set_sink(nullptr);
+  if (log_callback) {
+    log_callback.Release();
+    log_callback = Napi::ThreadSafeFunction();
+  }
+  logger::set_level(static_cast<logger::Level>(level));
+
+  if (!args[0].IsFunction()) {
+    return env.Undefined();
+  }
+
+  log_callback = Napi::ThreadSafeFunction::New(env, args[0].As<Napi::Function>(), "log", 0, 1);
+  // The handler must not keep the event loop alive on its own
+  log_callback.Unref(env);
+
+  logger::set_sink([callback = log_callback](std::vector<logger::Record> &records) mutable {
+    auto batch = std::make_shared<std::vector<logger::Record>>(std::move(records));
+    callback.NonBlockingCall([batch](Napi::Env env, Napi::Function js_callback) {
+      js_callback.Call({log_records(env, *batch)});
+    });
+  });
+
+  return env.Undefined();
+}
+
+Napi::Value scan_async(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 4) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto signature = copy_bytes(args[1].As<Napi::Uint8Array>());
+  auto mask = copy_bytes(args[2].As<Napi::Uint8Array>());
+  auto non_zero_mask = args[3].As<Napi::Boolean>().Value();
+  auto filter = copy_filter(args, 4);
+
+  return run_job<uintptr_t>(
+    env,
+    handle,
+    [handle, signature, mask, non_zero_mask, filter](const std::atomic<bool> &cancelled) {
+      return memory::find_pattern(handle, signature, mask, non_zero_mask, &cancelled, filter);
+    },
+    [](Napi::Env env, uintptr_t &result) -> Napi::Value { return Napi::Number::From(env, result); }
+  );
+}
+
+Napi::Value scan_all(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 4) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto signature_buffer = args[1].As<Napi::Uint8Array>();
+  auto mask_buffer = args[2].As<Napi::Uint8Array>();
+  auto non_zero_mask = args[3].As<Napi::Boolean>().Value();
+
+  auto signature = std::vector<uint8_t>(signature_buffer.ByteLength());
+  memcpy(signature.data(), signature_buffer.Data(), signature_buffer.ByteLength());
+
+  auto mask = std::vector<uint8_t>(mask_buffer.ByteLength());
+  memcpy(mask.data(), mask_buffer.Data(), mask_buffer.ByteLength());
+
+  const auto results = memory::find_pattern_all(handle, signature, mask, non_zero_mask, nullptr, copy_filter(args, 4));
+
+  auto result_array = Napi::Array::New(env, results.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    result_array.Set(i, Napi::Number::New(env, static_cast<double>(results[i])));
+  }
+
+  return result_array;
+}
+
+Napi::Value scan_all_async(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 4) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto signature = copy_bytes(args[1].As<Napi::Uint8Array>());
+  auto mask = copy_bytes(args[2].As<Napi::Uint8Array>());
+  auto non_zero_mask = args[3].As<Napi::Boolean>().Value();
+  auto filter = copy_filter(args, 4);
+
+  return run_job<std::vector<uintptr_t>>(
+    env,
+    handle,
+    [handle, signature, mask, non_zero_mask, filter](const std::atomic<bool> &cancelled) {
+      return memory::find_pattern_all(handle, signature, mask, non_zero_mask, &cancelled, filter);
+    },
+    [](Napi::Env env, std::vector<uintptr_t> &results) -> Napi::Value {
+      auto result_array = Napi::Array::New(env, results.size());
+      for (size_t i = 0; i < results.size(); i++) {
+        result_array.Set(i, Napi::Number::New(env, static_cast<double>(results[i])));
+      }
+      return result_array;
+    }
+  );
+}
+
+Napi::Value cancel_jobs(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  return Napi::Number::New(env, static_cast<double>(job_queue::cancel(handle)));
+}
+
+Napi::Value find_processes(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Array process_array = args[0].As<Napi::Array>();
+  std::vector<std::string> process_names;
+
+  for (size_t i = 0; i < process_array.Length(); i++) {
+    Napi::Value value = process_array[i];
+    if (value.IsString()) {
+      std::string name = value.As<Napi::String>().Utf8Value();
+      process_names.push_back(name);
+    }
+  }
+
+  auto processes = memory::find_processes(process_names);
+
+  auto arr = Napi::Array::New(env, processes.size());
+  for (size_t i = 0; i < processes.size(); i++) {
+    arr.Set(i, processes[i]);
+  }
+
+  return arr;
+}
+
+Napi::Value watch_processes(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 3) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto name_array = args[0].As<Napi::Array>();
+  auto interval = std::chrono::milliseconds(args[1].As<Napi::Number>().Int64Value());
+  auto callback = Napi::ThreadSafeFunction::New(env, args[2].As<Napi::Function>(), "processWatch", 0, 1);
+
+  auto names = std::vector<std::string>();
+  for (uint32_t i = 0; i < name_array.Length(); i++) {
+    names.push_back(name_array.Get(i).As<Napi::String>().Utf8Value());
+  }
+
+  auto deliver = [callback](std::vector<process_watcher::Event> events) mutable {
+    auto batch = std::make_shared<std::vector<process_watcher::Event>>(std::move(events));
+    callback.BlockingCall([batch](Napi::Env env, Napi::Function js_callback) {
+      js_callback.Call({process_events(env, *batch)});
+    });
+  };
+
+  auto watcher = std::make_unique<process_watcher::Watcher>(std::move(names), interval, std::move(deliver));
+  watcher->start();
+
+  auto watch = new ProcessWatch{std::move(watcher), callback, false};
+  return Napi::External<ProcessWatch>::New(env, watch, [](Napi::Env, ProcessWatch *data) {
+    data->stop();
+    delete data;
+  });
+}
+
+Napi::Value stop_process_watch(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  args[0].As<Napi::External<ProcessWatch>>().Data()->stop();
+
+  return env.Undefined();
+}
+
+Napi::Value open_process(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto process_id = args[0].As<Napi::Number>().Int64Value();
+  return Napi::Number::New(env, reinterpret_cast<uint64_t>(memory::open_process(process_id)));
+}
+
+Napi::Value close_handle(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+
+  job_queue::cancel(handle);
+  memory::close_handle(handle);
+  string_cache().forget(handle);
+
+  return env.Undefined();
+}
+
+Napi::Value is_process_exist(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  const auto exists = memory::is_process_exist(handle);
+
+  // Nothing left to scan, settle the pending jobs right away
+  if (!exists) {
+    job_queue::cancel(handle);
+  }
+
+  return Napi::Boolean::New(env, exists);
+}
+
+Napi::Value is_process_64bit(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto process_id = args[0].As<Napi::Number>().Int64Value();
+  return Napi::Boolean::New(env, memory::is_process_64bit(process_id));
+}
+
+Napi::Value get_process_start_time(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  return Napi::Number::New(env, static_cast<double>(memory::get_process_start_time(handle)));
+}
+
+Napi::Value is_readable(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 3) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto address = static_cast<uintptr_t>(args[1].As<Napi::Number>().Int64Value());
+  auto size = static_cast<std::size_t>(args[2].As<Napi::Number>().Int64Value());
+
+  return Napi::Boolean::New(env, memory::is_readable(handle, address, size));
+}
+
+Napi::Value set_read_backend(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 2) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto backend = args[1].As<Napi::Number>().Uint32Value();
+  if (backend > static_cast<uint32_t>(memory::ReadBackend::proc_mem)) {
+    Napi::TypeError::New(env, "Unknown read backend").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Boolean::New(env, memory::set_read_backend(handle, static_cast<memory::ReadBackend>(backend)));
+}
+
+Napi::Value get_read_backend(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  return Napi::Number::New(env, static_cast<uint32_t>(memory::get_read_backend(handle)));
+}
+
+Napi::Value get_process_path(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  return Napi::String::From(env, memory::get_process_path(handle));
+}
+
+Napi::Value get_process_command_line(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
+  if (args.Length() < 1) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+
+  auto command_line = memory::get_process_command_line(handle);
 
   return Napi::String::New(env, command_line);
 }
@@ -444,40 +1821,56 @@ Napi::Value read_csharp_string(const Napi::CallbackInfo &args) {
   auto bitness = args[1].As<Napi::Number>().Int32Value();
   auto address = get_intptr_value(args[2], args[1]);
 
-  if (address == 0) {
-    return Napi::String::New(env, "");
-  }
-
-  auto offset = bitness == 32 ? 4 : 8;
-
-  auto [string_length, length_success] = memory::read<int>(handle, address + offset);
-  if (!length_success) {
+  Napi::Value result;
+  if (!read_cached_string(env, handle, static_cast<uintptr_t>(address), bitness == 32 ? 4 : 8, result)) {
 #ifdef _WIN32
-    auto error_str = std::format(
-      "Couldn't read C# string length (base: {:x}, length: {:x}, last error: {})", address, address + sizeof(int), GetLastError()
-    );
+    auto error_str = std::format("Couldn't read C# string (base: {:x}, last error: {})", address, GetLastError());
 #else
-    auto error_str = std::format("Couldn't read C# string length (base: {:x})", address);
+    auto error_str = std::format("Couldn't read C# string (base: {:x})", address);
 #endif
     Napi::TypeError::New(env, error_str.c_str()).ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (string_length <= 0 || string_length >= 4096) {
-    return Napi::String::New(env, "");
-  }
+  return result;
+}
 
-  std::vector<wchar_t> string_buffer(string_length * 2);
-  auto string_success = memory::read_buffer(
-    handle, address + offset + 4, string_length * sizeof(wchar_t), reinterpret_cast<uint8_t *>(string_buffer.data())
-  );
+Napi::Value read_csharp_strings(const Napi::CallbackInfo &args) {
+  Napi::Env env = args.Env();
 
-  if (!string_success) {
-    Napi::TypeError::New(env, "Couldn't read C# string data").ThrowAsJavaScriptException();
+  if (args.Length() < 3) {
+    Napi::TypeError::New(env, "Wrong number of arguments").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  return Napi::String::New(env, reinterpret_cast<const char16_t *>(string_buffer.data()), string_length);
+  void *handle = reinterpret_cast<void *>(args[0].As<Napi::Number>().Int64Value());
+  auto bitness = args[1].As<Napi::Number>().Int32Value();
+  auto address_array = args[2].As<Napi::Float64Array>();
+
+  thread_local std::vector<uintptr_t> addresses;
+  thread_local std::vector<std::u16string> values;
+  thread_local std::vector<csharp_string::Status> statuses;
+
+  addresses.resize(address_array.ElementLength());
+  for (size_t i = 0; i < addresses.size(); i++) {
+    // Converting a negative double to an unsigned integer is undefined, such addresses are read as null strings
+    const auto address = address_array[i];
+    addresses[i] = address > 0 ? static_cast<uintptr_t>(address) : 0;
+  }
+
+  csharp_string::read_many(handle, addresses, bitness == 32 ? 4 : 8, values, statuses);
+
+  // Unreadable strings come back as null so one stale pointer does not fail the whole batch
+  auto result = Napi::Array::New(env, addresses.size());
+  for (size_t i = 0; i < addresses.size(); i++) {
+    if (statuses[i] == csharp_string::Status::ok) {
+      result.Set(i, string_cache().get(env, handle, addresses[i], values[i]));
+    } else {
+      result.Set(i, env.Null());
+    }
+  }
+
+  return result;
 }
 
 Napi::Value disable_power_throttling(const Napi::CallbackInfo &args) {
@@ -561,14 +1954,64 @@ Napi::Object init(Napi::Env env, Napi::Object exports) {
   exports["readFloat"] = Napi::Function::New(env, read_float);
   exports["readLong"] = Napi::Function::New(env, read_long);
   exports["readDouble"] = Napi::Function::New(env, read_double);
+  exports["tryReadByte"] = Napi::Function::New(env, try_read<int8_t>);
+  exports["tryReadShort"] = Napi::Function::New(env, try_read<int16_t>);
+  exports["tryReadInt"] = Napi::Function::New(env, try_read<int32_t>);
+  exports["tryReadUInt"] = Napi::Function::New(env, try_read<uint32_t>);
+  exports["tryReadFloat"] = Napi::Function::New(env, try_read<float>);
+  exports["tryReadLong"] = Napi::Function::New(env, try_read<int64_t>);
+  exports["tryReadDouble"] = Napi::Function::New(env, try_read<double>);
   exports["readBuffer"] = Napi::Function::New(env, read_buffer);
+  exports["readInto"] = Napi::Function::New(env, read_into);
+  exports["tryReadInto"] = Napi::Function::New(env, try_read_into);
+  exports["readPtrArray"] = Napi::Function::New(env, read_ptr_array);
   exports["readCSharpString"] = Napi::Function::New(env, read_csharp_string);
+  exports["readCSharpStrings"] = Napi::Function::New(env, read_csharp_strings);
+  exports["readSharpList"] = Napi::Function::New(env, read_sharp_list);
+  exports["readSharpDictionary"] = Napi::Function::New(env, read_sharp_dictionary);
+  exports["readBatch"] = Napi::Function::New(env, read_batch);
+  exports["readBatchAsync"] = Napi::Function::New(env, read_batch_async);
+  exports["compileChain"] = Napi::Function::New(env, compile_chain);
+  exports["evaluateChains"] = Napi::Function::New(env, evaluate_chains);
+  exports["compileStruct"] = Napi::Function::New(env, compile_struct);
+  exports["readStruct"] = Napi::Function::New(env, read_struct);
+  exports["readStructValues"] = Napi::Function::New(env, read_struct_values);
+  exports["createWatch"] = Napi::Function::New(env, create_watch);
+  exports["watchRange"] = Napi::Function::New(env, watch_range);
+  exports["watchChain"] = Napi::Function::New(env, watch_chain);
+  exports["unwatch"] = Napi::Function::New(env, unwatch);
+  exports["setWatchInterval"] = Napi::Function::New(env, set_watch_interval);
+  exports["setWatchSoftDirty"] = Napi::Function::New(env, set_watch_soft_dirty);
+  exports["getWatchStats"] = Napi::Function::New(env, get_watch_stats);
+  exports["stopWatch"] = Napi::Function::New(env, stop_watch);
+  exports["createSampler"] = Napi::Function::New(env, create_sampler);
+  exports["samplerTail"] = Napi::Function::New(env, sampler_tail);
+  exports["samplerSnapshot"] = Napi::Function::New(env, sampler_snapshot);
+  exports["drainSampler"] = Napi::Function::New(env, drain_sampler);
+  exports["removeSamplerChannel"] = Napi::Function::New(env, remove_sampler_channel);
+  exports["setSamplerInterval"] = Napi::Function::New(env, set_sampler_interval);
+  exports["stopSampler"] = Napi::Function::New(env, stop_sampler);
   exports["scanSync"] = Napi::Function::New(env, scan_sync);
-  exports["scan"] = Napi::Function::New(env, scan);
+  exports["getRegions"] = Napi::Function::New(env, get_regions);
+  exports["getStats"] = Napi::Function::New(env, get_stats);
+  exports["resetStats"] = Napi::Function::New(env, reset_stats);
+  exports["startTrace"] = Napi::Function::New(env, start_trace);
+  exports["stopTrace"] = Napi::Function::New(env, stop_trace);
+  exports["dumpTrace"] = Napi::Function::New(env, dump_trace);
+  exports["setLogHandler"] = Napi::Function::New(env, set_log_handler);
+  exports["scanAsync"] = Napi::Function::New(env, scan_async);
   exports["scanAll"] = Napi::Function::New(env, scan_all);
+  exports["scanAllAsync"] = Napi::Function::New(env, scan_all_async);
   exports["batchScan"] = Napi::Function::New(env, batch_scan);
+  exports["batchScanAsync"] = Napi::Function::New(env, batch_scan_async);
+  exports["cancelJobs"] = Napi::Function::New(env, cancel_jobs);
+  exports["watchProcesses"] = Napi::Function::New(env, watch_processes);
+  exports["stopProcessWatch"] = Napi::Function::New(env, stop_process_watch);
   exports["openProcess"] = Napi::Function::New(env, open_process);
   exports["closeHandle"] = Napi::Function::New(env, close_handle);
+  exports["isReadable"] = Napi::Function::New(env, is_readable);
+  exports["setReadBackend"] = Napi::Function::New(env, set_read_backend);
+  exports["getReadBackend"] = Napi::Function::New(env, get_read_backend);
   exports["findProcesses"] = Napi::Function::New(env, find_processes);
   exports["isProcessExist"] = Napi::Function::New(env, is_process_exist);
   exports["getProcessStartTime"] = Napi::Function::New(env, get_process_start_time);
@@ -0,0 +1,316 @@
+#include "logger.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#ifndef TSPROCESS_LOG_QUEUE_SIZE
+#define TSPROCESS_LOG_QUEUE_SIZE 1024
+#endif
+
+#ifndef TSPROCESS_LOG_BURST
+#define TSPROCESS_LOG_BURST 5
+#endif
+
+#ifndef TSPROCESS_LOG_WINDOW_MS
+#define TSPROCESS_LOG_WINDOW_MS 10000
+#endif
+
+namespace {
+
+static_assert((TSPROCESS_LOG_QUEUE_SIZE & (TSPROCESS_LOG_QUEUE_SIZE - 1)) == 0, "log queue size must be a power of two");
+
+// Records a call site may write per window
+constexpr uint32_t burst = TSPROCESS_LOG_BURST;
+constexpr int64_t window_ms = TSPROCESS_LOG_WINDOW_MS;
+constexpr std::size_t site_count = 256;
+constexpr auto drain_interval = std::chrono::milliseconds(100);
+
+int64_t now_ms() {
+  const auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+}
+
+// Bounded multi producer queue with a sequence number per cell, producers claim cells with a CAS on the enqueue
+// position and never wait on each other. Only the logger thread pops.
+class Queue {
+ public:
+  Queue() : cells_(TSPROCESS_LOG_QUEUE_SIZE) {
+    for (std::size_t i = 0; i < cells_.size(); ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Returns false if the queue is full
+  bool push(logger::Record &&record) {
+    auto position = enqueue_.load(std::memory_order_relaxed);
+    Cell *cell;
+
+    while (true) {
+      cell = &cells_[position & (cells_.size() - 1)];
+      const auto sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+
+      if (difference == 0) {
+        if (enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = enqueue_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->record = std::move(record);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(logger::Record &record) {
+    const auto position = dequeue_;
+    auto &cell = cells_[position & (cells_.size() - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+      return false;
+    }
+
+    record = std::move(cell.record);
+    cell.sequence.store(position + cells_.size(), std::memory_order_release);
+    dequeue_ = position + 1;
+    return true;
+  }
+
+  uint64_t pushed() const {
+    return enqueue_.load(std::memory_order_acquire);
+  }
+
+ private:
+  struct Cell {
+    std::atomic<uint64_t> sequence;
+    logger::Record record;
+  };
+
+  std::vector<Cell> cells_;
+  std::atomic<uint64_t> enqueue_{0};
+  uint64_t dequeue_ = 0;
+};
+
+// Rate limit state of one call site. Sites are claimed with a CAS on `key` and never released, once the table is full
+// new call sites are not limited.
+struct Site {
+  std::atomic<uint64_t> key{0};
+  std::atomic<int64_t> window_start{0};
+  std::atomic<uint32_t> count{0};
+  std::atomic<uint32_t> suppressed{0};
+  std::atomic<logger::Level> level{logger::Level::info};
+  std::atomic<const char *> file{nullptr};
+  std::atomic<uint32_t> line{0};
+};
+
+struct State {
+  Queue queue;
+  std::array<Site, site_count> sites;
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<logger::Level> level{logger::Level::info};
+
+  std::once_flag started;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable delivered_changed;
+  // Records taken off the queue and handed to the sink, guarded by `mutex`
+  uint64_t delivered = 0;
+
+  std::mutex sink_mutex;
+  logger::Sink sink;
+};
+
+State &state() {
+  static auto instance = new State();
+  return *instance;
+}
+
+uint64_t site_key(const std::source_location &site) {
+  const auto file = reinterpret_cast<uint64_t>(site.file_name());
+  return ((file * 0x9e3779b97f4a7c15ULL) ^ (static_cast<uint64_t>(site.line()) << 1)) | 1;
+}
+
+Site *find_site(State &state, const std::source_location &location) {
+  const auto key = site_key(location);
+
+  for (std::size_t probe = 0; probe < site_count; ++probe) {
+    auto &site = state.sites[(key + probe) % site_count];
+
+    auto current = site.key.load(std::memory_order_acquire);
+    if (current == 0 && site.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+      site.window_start.store(now_ms(), std::memory_order_relaxed);
+      site.line.store(location.line(), std::memory_order_relaxed);
+      site.file.store(location.file_name(), std::memory_order_release);
+      return &site;
+    }
+
+    if (current == key) {
+      return &site;
+    }
+  }
+
+  return nullptr;
+}
+
+void print(const std::vector<logger::Record> &records) {
+  static constexpr const char *names[] = {"debug", "info", "warn", "error"};
+
+  for (const auto &record : records) {
+    const auto name = names[static_cast<std::size_t>(record.level)];
+    if (record.suppressed == 0) {
+      std::printf("[tsprocess] %s: %s\n", name, record.message.c_str());
+    } else {
+      std::printf(
+        "[tsprocess] %s: %s (suppressed %u earlier messages from here)\n", name, record.message.c_str(), record.suppressed
+      );
+    }
+  }
+  std::fflush(stdout);
+}
+
+// Sites that went quiet while over their limit would otherwise never report what they dropped.
+void collect_suppressed(State &state, std::vector<logger::Record> &batch) {
+  const auto now = now_ms();
+
+  for (auto &site : state.sites) {
+    // The file is set last when a site is claimed
+    const auto file = site.file.load(std::memory_order_acquire);
+    if (file == nullptr || site.suppressed.load(std::memory_order_relaxed) == 0 ||
+        now - site.window_start.load(std::memory_order_relaxed) < window_ms) {
+      continue;
+    }
+
+    const auto suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+    if (suppressed == 0) {
+      continue;
+    }
+
+    batch.push_back(logger::Record{
+      site.level.load(std::memory_order_relaxed),
+      std::format(
+        "suppressed {} messages from {}:{}",
+        suppressed,
+        file,
+        site.line.load(std::memory_order_relaxed)
+      ),
+      0
+    });
+  }
+
+  const auto dropped = state.dropped.exchange(0, std::memory_order_relaxed);
+  if (dropped != 0) {
+    const auto message = std::format("dropped {} records, the log queue was full", dropped);
+    batch.push_back(logger::Record{logger::Level::warn, message, 0});
+  }
+}
+
+void run(State &state) {
+  auto batch = std::vector<logger::Record>();
+  auto record = logger::Record{};
+
+  while (true) {
+    {
+      std::unique_lock lock(state.mutex);
+      state.wake.wait_for(lock, drain_interval);
+    }
+
+    batch.clear();
+    uint64_t taken = 0;
+    while (state.queue.pop(record)) {
+      batch.push_back(std::move(record));
+      ++taken;
+    }
+    collect_suppressed(state, batch);
+
+    if (!batch.empty()) {
+      std::lock_guard lock(state.sink_mutex);
+      if (state.sink) {
+        state.sink(batch);
+      } else {
+        print(batch);
+      }
+    }
+
+    if (taken != 0) {
+      std::lock_guard lock(state.mutex);
+      state.delivered += taken;
+      state.delivered_changed.notify_all();
+    }
+  }
+}
+
+void ensure_started(State &state) {
+  std::call_once(state.started, [&state] {
+    std::thread([&state] { run(state); }).detach();
+  });
+}
+
+}  // namespace
+
+void logger::set_sink(Sink sink) {
+  auto &instance = state();
+  std::lock_guard lock(instance.sink_mutex);
+  instance.sink = std::move(sink);
+}
+
+void logger::set_level(Level level) {
+  state().level.store(level, std::memory_order_relaxed);
+}
+
+bool logger::enabled(Level level) {
+  return level >= state().level.load(std::memory_order_relaxed);
+}
+
+bool logger::admit(Level level, const std::source_location &location, uint32_t &suppressed) {
+  auto site = find_site(state(), location);
+  if (site == nullptr) {
+    return true;
+  }
+
+  site->level.store(level, std::memory_order_relaxed);
+  const auto now = now_ms();
+  auto window_start = site->window_start.load(std::memory_order_relaxed);
+  if (now - window_start >= window_ms &&
+      site->window_start.compare_exchange_strong(window_start, now, std::memory_order_relaxed)) {
+    site->count.store(0, std::memory_order_relaxed);
+    suppressed = site->suppressed.exchange(0, std::memory_order_relaxed);
+  }
+
+  if (site->count.fetch_add(1, std::memory_order_relaxed) < burst) {
+    return true;
+  }
+
+  site->suppressed.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void logger::push(Level level, std::string message, uint32_t suppressed) {
+  auto &instance = state();
+  ensure_started(instance);
+
+  if (!instance.queue.push(Record{level, std::move(message), suppressed})) {
+    instance.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  instance.wake.notify_one();
+}
+
+void logger::flush() {
+  auto &instance = state();
+  const auto target = instance.queue.pushed();
+
+  std::unique_lock lock(instance.mutex);
+  instance.wake.notify_one();
+  instance.delivered_changed.wait(lock, [&] {
+    return instance.delivered >= target;
+  });
+}
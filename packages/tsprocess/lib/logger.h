@@ -1,12 +1,85 @@
-#include <cstdio>
+#pragma once
+
+#include <cstdint>
 #include <format>
+#include <functional>
+#include <source_location>
 #include <string>
+#include <type_traits>
+#include <vector>
 
+// Records are formatted on the calling thread, queued without locking and written by a background thread, so logging
+// from a polling loop never blocks on stdout. Each call site may write a few records per window, further ones are
+// only counted and reported as suppressed once the window is over.
 namespace logger {
 
+enum class Level : uint8_t { debug, info, warn, error };
+
+struct Record {
+  Level level;
+  std::string message;
+  // Records of the same call site dropped by the rate limit right before this one
+  uint32_t suppressed;
+};
+
+// Receives the records in batches on the logger thread. Without a sink records are printed to stdout.
+using Sink = std::function<void(std::vector<Record> &records)>;
+
+void set_sink(Sink sink);
+void set_level(Level level);
+bool enabled(Level level);
+
+// Returns whether the call site may write a record now, `suppressed` receives the records it dropped before.
+bool admit(Level level, const std::source_location &site, uint32_t &suppressed);
+void push(Level level, std::string message, uint32_t suppressed);
+
+// Blocks until every record queued so far has reached the sink.
+void flush();
+
+// Format string that also captures where it was written, which identifies the call site for the rate limit.
+template <typename... Args>
+struct Format {
+  template <typename T>
+  consteval Format(const T &format, std::source_location site = std::source_location::current())
+      : format(format), site(site) {}
+
+  std::format_string<Args...> format;
+  std::source_location site;
+};
+
+template <typename... Args>
+void log(Level level, Format<std::type_identity_t<Args>...> format, Args &&...args) {
+  uint32_t suppressed = 0;
+  if (!enabled(level) || !admit(level, format.site, suppressed)) {
+    return;
+  }
+
+  push(level, std::format(format.format, std::forward<Args>(args)...), suppressed);
+}
+
+template <typename... Args>
+void debug(Format<std::type_identity_t<Args>...> format, Args &&...args) {
+  log<Args...>(Level::debug, format, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void info(Format<std::type_identity_t<Args>...> format, Args &&...args) {
+  log<Args...>(Level::info, format, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void warn(Format<std::type_identity_t<Args>...> format, Args &&...args) {
+  log<Args...>(Level::warn, format, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void error(Format<std::type_identity_t<Args>...> format, Args &&...args) {
+  log<Args...>(Level::error, format, std::forward<Args>(args)...);
+}
+
 template <typename... Args>
-void println(std::format_string<Args...> format, Args &&...args) {
-  std::printf("%s\n", std::format(format, std::forward<Args>(args)...).c_str());
+void println(Format<std::type_identity_t<Args>...> format, Args &&...args) {
+  log<Args...>(Level::info, format, std::forward<Args>(args)...);
 }
 
 }  // namespace logger
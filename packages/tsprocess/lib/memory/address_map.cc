@@ -0,0 +1,73 @@
+#include "address_map.h"
+
+#include <algorithm>
+
+address_map::AddressMap::AddressMap() : intervals_(std::make_shared<const Intervals>()) {}
+
+bool address_map::AddressMap::contains(uintptr_t address, std::size_t size) const {
+  const auto intervals = intervals_.load(std::memory_order_acquire);
+
+  // First interval ending after the address, the only one that can contain it
+  const auto it = std::upper_bound(intervals->begin(), intervals->end(), address, [](uintptr_t value, const Interval &item) {
+    return value < item.end;
+  });
+
+  return it != intervals->end() && it->start <= address && size <= it->end - address;
+}
+
+void address_map::AddressMap::assign(const RegionTable &table) {
+  auto intervals = std::make_shared<Intervals>();
+
+  for (const auto &region : table.regions) {
+    if ((region.protection & MemoryRegion::read) == 0 || region.size == 0) {
+      continue;
+    }
+
+    // Regions come sorted, touching ones are merged so reads spanning two mappings are accepted
+    if (!intervals->empty() && intervals->back().end == region.address) {
+      intervals->back().end = region.address + region.size;
+      continue;
+    }
+
+    intervals->push_back(Interval{region.address, region.address + region.size});
+  }
+
+  intervals_.store(std::move(intervals), std::memory_order_release);
+}
+
+void address_map::AddressMap::insert(uintptr_t start, uintptr_t end) {
+  if (start >= end) {
+    return;
+  }
+
+  const auto current = intervals_.load(std::memory_order_acquire);
+  auto intervals = std::make_shared<Intervals>();
+  intervals->reserve(current->size() + 1);
+
+  auto merged = Interval{start, end};
+  auto placed = false;
+  for (const auto &item : *current) {
+    if (item.end < merged.start) {
+      intervals->push_back(item);
+    } else if (merged.end < item.start) {
+      if (!placed) {
+        intervals->push_back(merged);
+        placed = true;
+      }
+      intervals->push_back(item);
+    } else {
+      merged.start = std::min(merged.start, item.start);
+      merged.end = std::max(merged.end, item.end);
+    }
+  }
+
+  if (!placed) {
+    intervals->push_back(merged);
+  }
+
+  intervals_.store(std::move(intervals), std::memory_order_release);
+}
+
+bool address_map::AddressMap::empty() const {
+  return intervals_.load(std::memory_order_acquire)->empty();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "memory.h"
+
+namespace address_map {
+
+struct Interval {
+  uintptr_t start;
+  uintptr_t end;
+};
+
+// Sorted, non-overlapping address ranges known to be readable. Lookups read an immutable snapshot without locking,
+// updates copy it, which suits a set that is read on every small read and changes a few times per second at most.
+// Updates must not run concurrently with each other.
+class AddressMap {
+ public:
+  AddressMap();
+
+  // True if [address, address + size) lies inside one merged interval.
+  bool contains(uintptr_t address, std::size_t size) const;
+
+  // Replaces the intervals with the readable regions of `table`.
+  void assign(const RegionTable &table);
+  void insert(uintptr_t start, uintptr_t end);
+
+  bool empty() const;
+
+ private:
+  using Intervals = std::vector<Interval>;
+
+  std::atomic<std::shared_ptr<const Intervals>> intervals_;
+};
+
+}  // namespace address_map
@@ -0,0 +1,136 @@
+#include "collections.h"
+
+#include <algorithm>
+#include <cstring>
+#include "memory.h"
+
+namespace {
+
+template <class T>
+T load(const uint8_t *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+uintptr_t load_pointer(const uint8_t *data, uint8_t pointer_size) {
+  return pointer_size == 8 ? static_cast<uintptr_t>(load<uint64_t>(data)) : load<uint32_t>(data);
+}
+
+}  // namespace
+
+bool collections::read_list(void *process, uintptr_t list, uint8_t pointer_size, std::vector<double> &items) {
+  items.clear();
+  if (list == 0) {
+    return false;
+  }
+
+  // List<T> keeps _items right after the method table and _size after _items (and _syncRoot on .NET Framework)
+  const auto items_offset = pointer_size;
+  const auto size_offset = pointer_size == 8 ? 0x10u : 0xcu;
+
+  uint8_t header[0x10];
+  if (!memory::read_buffer(process, list + items_offset, size_offset + 4 - items_offset, header)) {
+    return false;
+  }
+
+  const auto array = load_pointer(header, pointer_size);
+  const auto size = load<int32_t>(header + (size_offset - items_offset));
+  if (size < 0 || static_cast<std::size_t>(size) > max_count) {
+    return false;
+  }
+
+  // Lists created with capacity 0 have no backing array yet
+  if (array == 0) {
+    return true;
+  }
+
+  thread_local std::vector<uint8_t> buffer;
+  buffer.resize(static_cast<std::size_t>(size) * pointer_size);
+  if (!buffer.empty() &&
+      !memory::read_buffer(process, array + array_header_size(pointer_size), buffer.size(), buffer.data())) {
+    return false;
+  }
+
+  items.resize(static_cast<std::size_t>(size));
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    items[i] = static_cast<double>(load_pointer(buffer.data() + i * pointer_size, pointer_size));
+  }
+
+  return true;
+}
+
+bool collections::read_dictionary(
+  void *process,
+  uintptr_t dictionary,
+  const DictionaryLayout &layout,
+  uint8_t pointer_size,
+  DictionaryEntries &entries
+) {
+  entries.indices.clear();
+  entries.keys.clear();
+  entries.values.clear();
+
+  if (dictionary == 0 || layout.entry_size == 0) {
+    return false;
+  }
+
+  const auto key_size = struct_layout::type_size(layout.key.type, pointer_size);
+  const auto value_size = struct_layout::type_size(layout.value.type, pointer_size);
+  const auto fits = [&layout](int64_t offset, std::size_t size) {
+    return offset < 0 || offset + size <= layout.entry_size;
+  };
+  if (!fits(layout.key.offset, key_size) || !fits(layout.value.offset, value_size) || !fits(layout.hash_offset, 4) ||
+      !fits(layout.next_offset, 4)) {
+    return false;
+  }
+
+  const auto start = std::min(layout.entries_offset, layout.count_offset);
+  const auto end = std::max(layout.entries_offset + pointer_size, layout.count_offset + 4);
+
+  thread_local std::vector<uint8_t> header;
+  header.resize(end - start);
+  if (!memory::read_buffer(process, dictionary + start, header.size(), header.data())) {
+    return false;
+  }
+
+  const auto array = load_pointer(header.data() + (layout.entries_offset - start), pointer_size);
+  const auto count = load<int32_t>(header.data() + (layout.count_offset - start));
+  if (count < 0 || static_cast<std::size_t>(count) > max_count) {
+    return false;
+  }
+
+  // Entries are allocated lazily on the first insert
+  if (array == 0) {
+    return true;
+  }
+
+  thread_local std::vector<uint8_t> buffer;
+  buffer.resize(static_cast<std::size_t>(count) * layout.entry_size);
+  if (!buffer.empty() &&
+      !memory::read_buffer(process, array + array_header_size(pointer_size), buffer.size(), buffer.data())) {
+    return false;
+  }
+
+  entries.indices.reserve(static_cast<std::size_t>(count));
+  entries.keys.reserve(static_cast<std::size_t>(count));
+  entries.values.reserve(static_cast<std::size_t>(count));
+
+  for (uint32_t i = 0; i < static_cast<uint32_t>(count); ++i) {
+    const auto entry = buffer.data() + static_cast<std::size_t>(i) * layout.entry_size;
+
+    if (layout.hash_offset >= 0 && load<int32_t>(entry + layout.hash_offset) < 0) {
+      continue;
+    }
+
+    if (layout.next_offset >= 0 && load<int32_t>(entry + layout.next_offset) < -1) {
+      continue;
+    }
+
+    entries.indices.push_back(i);
+    entries.keys.push_back(struct_layout::decode_value(layout.key.type, entry + layout.key.offset, pointer_size));
+    entries.values.push_back(struct_layout::decode_value(layout.value.type, entry + layout.value.offset, pointer_size));
+  }
+
+  return true;
+}
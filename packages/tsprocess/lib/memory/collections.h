@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "struct_layout.h"
+
+namespace collections {
+
+// Upper bound for list and dictionary sizes, anything above is treated as a stale object
+constexpr std::size_t max_count = 0x100000;
+
+// Where the pieces of a Dictionary<K, V> live. The same reader serves the 32-bit .NET Framework layout of stable and
+// the 64-bit .NET layout of lazer, the offsets are all relative to the object, the entries array or one entry.
+struct DictionaryLayout {
+  uint32_t entries_offset;
+  uint32_t count_offset;
+  uint32_t entry_size;
+  // Entries with a negative hash code are free (.NET Framework), -1 disables the check
+  int32_t hash_offset;
+  // Entries with next < -1 are on the free list (.NET), -1 disables the check
+  int32_t next_offset;
+  struct_layout::Field key;
+  struct_layout::Field value;
+};
+
+struct DictionaryEntries {
+  // Position of every used entry in the entries array
+  std::vector<uint32_t> indices;
+  std::vector<double> keys;
+  std::vector<double> values;
+};
+
+// Bytes in front of the first element of an array object.
+inline uint32_t array_header_size(uint8_t pointer_size) {
+  return pointer_size * 2;
+}
+
+// Reads the element pointers of a List<T> of reference types: the list header and the backing array, one read each.
+bool read_list(void *process, uintptr_t list, uint8_t pointer_size, std::vector<double> &items);
+
+// Reads the used entries of a Dictionary<K, V> with one read for the header and one for the entries array.
+bool read_dictionary(
+  void *process,
+  uintptr_t dictionary,
+  const DictionaryLayout &layout,
+  uint8_t pointer_size,
+  DictionaryEntries &entries
+);
+
+}  // namespace collections
@@ -0,0 +1,156 @@
+#include "csharp_string.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "memory.h"
+#include "stats.h"
+
+namespace {
+
+// Length field followed by the first speculative_length characters
+constexpr std::size_t speculative_size = sizeof(int32_t) + csharp_string::speculative_length * sizeof(char16_t);
+
+using SpeculativeBuffer = std::array<uint8_t, speculative_size>;
+
+int32_t load_length(const uint8_t *data) {
+  int32_t length;
+  std::memcpy(&length, data, sizeof(length));
+  return length;
+}
+
+bool valid_length(int32_t length) {
+  return length > 0 && length < csharp_string::max_length;
+}
+
+// Completes a string from its speculative window, reading whatever did not fit in it.
+csharp_string::Status decode(
+  void *process,
+  uintptr_t address,
+  uint8_t pointer_size,
+  const uint8_t *window,
+  std::u16string &out
+) {
+  const auto length = load_length(window);
+  if (!valid_length(length)) {
+    out.clear();
+    return csharp_string::Status::ok;
+  }
+
+  out.resize(static_cast<std::size_t>(length));
+
+  const auto inline_length = std::min<std::size_t>(out.size(), csharp_string::speculative_length);
+  std::memcpy(out.data(), window + sizeof(int32_t), inline_length * sizeof(char16_t));
+
+  if (inline_length == out.size()) {
+    return csharp_string::Status::ok;
+  }
+
+  const auto rest = reinterpret_cast<uint8_t *>(out.data() + inline_length);
+  const auto rest_address = address + pointer_size + speculative_size;
+  if (!memory::read_buffer(process, rest_address, (out.size() - inline_length) * sizeof(char16_t), rest)) {
+    out.clear();
+    return csharp_string::Status::read_failed;
+  }
+
+  return csharp_string::Status::ok;
+}
+
+// Exact two step read, used when the speculative window runs into memory that cannot be read.
+csharp_string::Status read_exact(void *process, uintptr_t address, uint8_t pointer_size, std::u16string &out) {
+  out.clear();
+
+  const auto [length, length_success] = memory::read<int32_t>(process, address + pointer_size);
+  if (!length_success) {
+    return csharp_string::Status::read_failed;
+  }
+
+  if (!valid_length(length)) {
+    return csharp_string::Status::ok;
+  }
+
+  out.resize(static_cast<std::size_t>(length));
+  const auto data = reinterpret_cast<uint8_t *>(out.data());
+  if (!memory::read_buffer(process, address + pointer_size + sizeof(int32_t), out.size() * sizeof(char16_t), data)) {
+    out.clear();
+    return csharp_string::Status::read_failed;
+  }
+
+  return csharp_string::Status::ok;
+}
+
+}  // namespace
+
+csharp_string::Status csharp_string::read(void *process, uintptr_t address, uint8_t pointer_size, std::u16string &out) {
+  auto scope = stats::Scope(process, stats::Operation::csharp_string);
+  if (address == 0) {
+    out.clear();
+    return Status::ok;
+  }
+
+  SpeculativeBuffer window;
+  const auto status = memory::read_buffer(process, address + pointer_size, window.size(), window.data())
+                        ? decode(process, address, pointer_size, window.data(), out)
+                        : read_exact(process, address, pointer_size, out);
+
+  scope.add_bytes(out.size() * sizeof(char16_t));
+  if (status != Status::ok) {
+    scope.fail();
+  }
+  return status;
+}
+
+void csharp_string::read_many(
+  void *process,
+  std::span<const uintptr_t> addresses,
+  uint8_t pointer_size,
+  std::vector<std::u16string> &out,
+  std::vector<Status> &statuses
+) {
+  auto scope = stats::Scope(process, stats::Operation::csharp_string);
+  out.resize(addresses.size());
+  statuses.assign(addresses.size(), Status::ok);
+
+  thread_local std::vector<ReadRequest> requests;
+  thread_local std::vector<std::size_t> requested;
+  thread_local std::vector<uint8_t> buffer;
+  thread_local std::vector<uint8_t> success;
+
+  requests.clear();
+  requested.clear();
+
+  for (std::size_t i = 0; i < addresses.size(); ++i) {
+    if (addresses[i] == 0) {
+      out[i].clear();
+      continue;
+    }
+
+    requests.push_back(ReadRequest{addresses[i] + pointer_size, speculative_size});
+    requested.push_back(i);
+  }
+
+  if (requests.empty()) {
+    return;
+  }
+
+  buffer.resize(requests.size() * speculative_size);
+  success.assign((requests.size() + 7) / 8, 0);
+  memory::read_batch(process, requests, buffer.data(), success.data());
+
+  for (std::size_t i = 0; i < requested.size(); ++i) {
+    const auto index = requested[i];
+    const auto read = (success[i / 8] >> (i % 8)) & 1;
+
+    if (read) {
+      const auto window = buffer.data() + i * speculative_size;
+      statuses[index] = decode(process, addresses[index], pointer_size, window, out[index]);
+    } else {
+      statuses[index] = read_exact(process, addresses[index], pointer_size, out[index]);
+    }
+
+    scope.add_bytes(out[index].size() * sizeof(char16_t));
+    if (statuses[index] != Status::ok) {
+      scope.fail();
+    }
+  }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace csharp_string {
+
+// Strings at or above this length are treated as garbage and read as empty
+constexpr int32_t max_length = 4096;
+
+// Characters fetched together with the length, strings up to this size cost a single read
+constexpr std::size_t speculative_length = 60;
+
+enum class Status : uint8_t { ok, read_failed };
+
+// Reads the .NET string object at `address` into `out`. Null pointers and implausible lengths give an empty string.
+Status read(void *process, uintptr_t address, uint8_t pointer_size, std::u16string &out);
+
+// Reads many strings at once: the speculative part of every string goes through one memory::read_batch, only strings
+// longer than speculative_length or whose speculative read failed are read again one by one.
+void read_many(
+  void *process,
+  std::span<const uintptr_t> addresses,
+  uint8_t pointer_size,
+  std::vector<std::u16string> &out,
+  std::vector<Status> &statuses
+);
+
+}  // namespace csharp_string
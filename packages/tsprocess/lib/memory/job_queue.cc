@@ -0,0 +1,106 @@
+#include "job_queue.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of jobs running at the same time
+#ifndef TSPROCESS_JOB_THREADS
+#define TSPROCESS_JOB_THREADS 2
+#endif
+
+namespace {
+
+struct Entry {
+  void *owner;
+  job_queue::Token token;
+  job_queue::Job job;
+};
+
+class Queue {
+ public:
+  Queue() {
+    for (unsigned i = 0; i < TSPROCESS_JOB_THREADS; ++i) {
+      std::thread([this] { worker_loop(); }).detach();
+    }
+  }
+
+  job_queue::Token submit(void *owner, job_queue::Job job) {
+    auto token = std::make_shared<std::atomic<bool>>(false);
+
+    {
+      std::lock_guard lock(mutex_);
+      queued_.push_back(Entry{owner, token, std::move(job)});
+      active_.push_back(Entry{owner, token, {}});
+    }
+    wake_.notify_one();
+
+    return token;
+  }
+
+  std::size_t cancel(void *owner) {
+    std::lock_guard lock(mutex_);
+
+    std::size_t count = 0;
+    for (const auto &entry : active_) {
+      if (entry.owner == owner) {
+        entry.token->store(true);
+        ++count;
+      }
+    }
+
+    return count;
+  }
+
+  std::size_t pending() {
+    std::lock_guard lock(mutex_);
+    return active_.size();
+  }
+
+ private:
+  void worker_loop() {
+    while (true) {
+      Entry entry;
+      {
+        std::unique_lock lock(mutex_);
+        wake_.wait(lock, [this] { return !queued_.empty(); });
+        entry = std::move(queued_.front());
+        queued_.pop_front();
+      }
+
+      entry.job(*entry.token);
+
+      std::lock_guard lock(mutex_);
+      std::erase_if(active_, [&entry](const Entry &item) { return item.token == entry.token; });
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<Entry> queued_;
+  // Queued and running jobs, for cancel()
+  std::vector<Entry> active_;
+};
+
+Queue &queue() {
+  // Intentionally leaked, the workers are detached and may still be waiting when the module is unloaded
+  static auto instance = new Queue();
+  return *instance;
+}
+
+}  // namespace
+
+job_queue::Token job_queue::submit(void *owner, Job job) {
+  return queue().submit(owner, std::move(job));
+}
+
+std::size_t job_queue::cancel(void *owner) {
+  return queue().cancel(owner);
+}
+
+std::size_t job_queue::pending() {
+  return queue().pending();
+}
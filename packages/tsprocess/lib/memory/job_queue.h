@@ -0,0 +1,27 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace job_queue {
+
+// Set once the job should stop, checked by the job itself
+using Token = std::shared_ptr<std::atomic<bool>>;
+
+using Job = std::function<void(const std::atomic<bool> &cancelled)>;
+
+// Queues `job` for one of the job workers, jobs start in submission order. `owner` groups jobs for cancel(), the
+// bindings use the process handle. The workers only coordinate jobs, the heavy lifting inside a job (scans) still goes
+// through scan_pool, so a handful of them is enough no matter how many processes are attached.
+Token submit(void *owner, Job job);
+
+// Sets the token of every queued and running job of `owner` and returns how many there were. Queued jobs still run,
+// with their token already set, so every job gets to report its cancellation.
+std::size_t cancel(void *owner);
+
+// Jobs queued or running.
+std::size_t pending();
+
+}  // namespace job_queue
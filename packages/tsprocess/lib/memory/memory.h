@@ -1,16 +1,67 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <memory>
 #include <span>
 #include <string>
 #include <string_view>
 #include <tuple>
 #include <vector>
+#include "scan_pool.h"
+#include "scanner.h"
+#include "stats.h"
+#include "tracer.h"
+
+#ifndef TSPROCESS_SCAN_CHUNK_SIZE
+#define TSPROCESS_SCAN_CHUNK_SIZE 0x400000
+#endif
 
 struct MemoryRegion {
+  static constexpr uint8_t read = 1;
+  static constexpr uint8_t write = 2;
+  static constexpr uint8_t execute = 4;
+
   uintptr_t address;
   std::size_t size;
+  // Combination of read, write and execute
+  uint8_t protection;
+  // Writes are visible to other mappings of the same object (MAP_SHARED)
+  bool shared;
+  // Not backed by a file: heaps, stacks, JIT code
+  bool anonymous;
+  // Offset of the mapping in its backing file
+  uint64_t offset;
+  uint64_t inode;
+  // Backing file or a pseudo name such as [heap], points into the RegionTable the region came from
+  std::string_view path;
+};
+
+// Every mapping of a process, sorted by address. Regions reference `names`, so they are only valid while the table is.
+struct RegionTable {
+  std::string names;
+  std::vector<MemoryRegion> regions;
+};
+
+// Selects the regions a scan reads. The defaults select what scans have always read: readable and writable memory.
+struct RegionFilter {
+  // Protection bits a region must have, read is always required
+  uint8_t protection = MemoryRegion::read | MemoryRegion::write;
+  // Protection bits a region must not have
+  uint8_t excluded_protection = 0;
+  bool anonymous_only = false;
+  // Only regions whose path contains this, any region when empty
+  std::string path;
+  // Regions are clipped to [start, end)
+  uintptr_t start = 0;
+  uintptr_t end = UINTPTR_MAX;
+  // Skip pages of anonymous regions that were never touched, they read as zeros
+  bool skip_unpopulated = true;
+  // Only read pages that are in memory, swapped out and not yet loaded file pages are skipped too. Matches on those
+  // pages are missed, in exchange the scan never faults file pages in or swaps pages back in for the target.
+  bool resident_only = false;
 };
 
 struct Pattern {
@@ -19,6 +70,8 @@ struct Pattern {
   std::span<uint8_t> mask;
   bool non_zero_mask;
   bool found;
+  // Report every match instead of only the lowest one
+  bool all;
 };
 
 struct PatternResult {
@@ -26,9 +79,89 @@ struct PatternResult {
   uintptr_t address;
 };
 
+struct ReadRequest {
+  uintptr_t address;
+  std::size_t size;
+};
+
 namespace memory {
 
-std::vector<MemoryRegion> query_regions(void *process);
+// Syscall used to read from a process on Linux. Automatic sends small reads through process_vm_readv and times large
+// reads with both backends for a few calls before settling on the faster one for that process.
+enum class ReadBackend : uint8_t {
+  automatic,
+  vm_readv,
+  // pread on a /proc/<pid>/mem descriptor kept open for the lifetime of the handle
+  proc_mem,
+};
+
+// Returns every mapping of `process`. On Linux the table is cached per open handle and parsed again once the size of
+// the address space changed or the table is older than TSPROCESS_REGION_CACHE_MS, which catches the remaps that keep
+// the size.
+std::shared_ptr<const RegionTable> query_regions(void *process);
+
+inline bool region_matches(const MemoryRegion &region, const RegionFilter &filter) {
+  const auto required = filter.protection | MemoryRegion::read;
+  if ((region.protection & required) != required || (region.protection & filter.excluded_protection) != 0) {
+    return false;
+  }
+
+  if (filter.anonymous_only && !region.anonymous) {
+    return false;
+  }
+
+  if (!filter.path.empty() && region.path.find(filter.path) == std::string_view::npos) {
+    return false;
+  }
+
+  return region.address < filter.end && region.address + region.size > filter.start;
+}
+
+// Cuts the pages `filter` skips out of `regions` by their pagemap flags (Linux only, other platforms keep every page).
+// A match that starts on a kept page and runs into a skipped one is missed, which only matters for signatures ending in
+// zero bytes.
+std::vector<MemoryRegion> populated_regions(void *process, std::vector<MemoryRegion> regions, const RegionFilter &filter);
+
+// Regions of `table` selected by `filter`, clipped to its address range. The result references the table.
+inline std::vector<MemoryRegion> filter_regions(const RegionTable &table, const RegionFilter &filter) {
+  auto regions = std::vector<MemoryRegion>();
+
+  for (const auto &region : table.regions) {
+    if (!region_matches(region, filter)) {
+      continue;
+    }
+
+    const auto start = std::max(region.address, filter.start);
+    const auto end = std::min(region.address + region.size, filter.end);
+
+    auto clipped = region;
+    clipped.address = start;
+    clipped.size = end - start;
+    regions.push_back(clipped);
+  }
+
+  return regions;
+}
+
+// Regions a scan reads: the ones selected by `filter` without the pages it skips. Counted in the stats of `process`.
+inline std::vector<MemoryRegion> scan_regions(void *process, const RegionTable &table, const RegionFilter &filter) {
+  const auto selected = filter_regions(table, filter);
+
+  std::size_t selected_size = 0;
+  for (const auto &region : selected) {
+    selected_size += region.size;
+  }
+
+  auto regions = populated_regions(process, selected, filter);
+
+  std::size_t scanned_size = 0;
+  for (const auto &region : regions) {
+    scanned_size += region.size;
+  }
+
+  stats::count_scan(process, scanned_size, selected_size - scanned_size);
+  return regions;
+}
 
 std::vector<uint32_t> find_processes(const std::vector<std::string> &process_names);
 
@@ -42,8 +175,21 @@ std::string get_process_command_line(void *process);
 std::string get_process_cwd(void *process);
 void *get_foreground_window_process();
 
+// Returns false if the backend is not available for `process`, only automatic is available outside Linux.
+bool set_read_backend(void *process, ReadBackend backend);
+// Backend used for large reads, automatic while it is still being measured.
+ReadBackend get_read_backend(void *process);
+
+// Whether [address, address + size) is mapped readable. On Linux this is answered from the readable ranges kept per
+// open handle, which reads also check so pointers into unmapped memory fail without a syscall.
+bool is_readable(void *process, uintptr_t address, std::size_t size);
+
 bool read_buffer(void *process, uintptr_t address, std::size_t size, uint8_t *buffer);
 
+// Reads every request into `buffer` back to back, request i landing right after the bytes of request i - 1, and sets
+// bit i of `success` for each request that was read completely. Returns the number of successful requests.
+std::size_t read_batch(void *process, std::span<const ReadRequest> requests, uint8_t *buffer, uint8_t *success);
+
 template <class T>
 std::tuple<T, bool> read(void *process, uintptr_t address) {
   T data;
@@ -51,142 +197,332 @@ std::tuple<T, bool> read(void *process, uintptr_t address) {
   return std::make_tuple(data, success);
 }
 
-inline bool scan(
-  std::vector<uint8_t> buffer,
-  std::span<uint8_t> signature,
-  std::span<uint8_t> mask,
-  size_t &offset,
-  bool non_zero_mask
-) {
-  offset = 0;
+// Why a read failed, reported by the reads that return a status instead of only a flag.
+enum class ReadStatus : uint8_t {
+  ok = 0,
+  // The address lies in the first 64 KiB, which is never mapped, so it came from a null pointer plus an offset
+  zero_pointer = 1,
+  // Nothing readable is mapped at the address
+  unmapped = 2,
+  // The range starts in readable memory but runs past its end
+  partial = 3,
+  // The system denied access to the process
+  permission = 4,
+  // Any other failure, such as the process having exited
+  failed = 5,
+};
 
-  for (size_t i = 0; i + signature.size() <= buffer.size(); ++i) {
-    bool found = true;
-    for (size_t j = 0; j < signature.size(); ++j) {
-      if (non_zero_mask) {
-        if ((buffer[i + j] == signature[j] && mask[j] == 1) || (mask[j] == 0 && buffer[i + j] != 0)) {
-          continue;
-        }
-      } else {
-        if (buffer[i + j] == signature[j] || mask[j] == 0) {
-          continue;
-        }
-      }
+constexpr uintptr_t null_region_size = 0x10000;
 
-      found = false;
-      break;
-    }
+// Classifies a failed read of [address, address + size) from the readable ranges alone. Batches use this, a request
+// that was skipped or failed among others has no error code of its own, so they never report permission.
+inline ReadStatus unreadable_status(void *process, uintptr_t address, std::size_t size) {
+  if (address < null_region_size) {
+    return ReadStatus::zero_pointer;
+  }
 
-    if (!found) {
-      continue;
-    }
+  if (!is_readable(process, address, size)) {
+    return is_readable(process, address, 1) ? ReadStatus::partial : ReadStatus::unmapped;
+  }
 
-    offset = static_cast<size_t>(i);
-    return true;
+  return ReadStatus::failed;
+}
+
+// Classifies a read of [address, address + size) that just failed. It inspects errno (GetLastError on Windows), so it
+// has to run right after the failing read. Only failed reads pay for the classification.
+ReadStatus read_failure(void *process, uintptr_t address, std::size_t size);
+
+inline ReadStatus read_buffer_status(void *process, uintptr_t address, std::size_t size, uint8_t *buffer) {
+  if (address < null_region_size) {
+    return ReadStatus::zero_pointer;
   }
 
-  return false;
+  return read_buffer(process, address, size, buffer) ? ReadStatus::ok : read_failure(process, address, size);
+}
+
+template <class T>
+ReadStatus read_status(void *process, uintptr_t address, T &value) {
+  return read_buffer_status(process, address, sizeof(T), reinterpret_cast<uint8_t *>(&value));
 }
 
 inline bool scan(
-  std::vector<uint8_t> buffer,
-  std::vector<uint8_t> signature,
-  std::vector<uint8_t> mask,
+  std::span<const uint8_t> buffer,
+  std::span<const uint8_t> signature,
+  std::span<const uint8_t> mask,
   size_t &offset,
   bool non_zero_mask
 ) {
   offset = 0;
 
-  for (size_t i = 0; i + signature.size() <= buffer.size(); ++i) {
-    auto found = true;
-    for (size_t j = 0; j < signature.size(); ++j) {
-      if (non_zero_mask) {
-        if ((buffer[i + j] == signature[j] && mask[j] == 1) || (mask[j] == 0 && buffer[i + j] != 0)) {
-          continue;
-        }
-      } else {
-        if (buffer[i + j] == signature[j] || mask[j] == 0) {
-          continue;
-        }
-      }
+  const auto pattern = scanner::CompiledPattern(signature, mask, non_zero_mask);
+  const auto position = pattern.find(buffer);
+  if (position == scanner::CompiledPattern::npos) {
+    return false;
+  }
+
+  offset = position;
+  return true;
+}
+
+// Regions are scanned through a reusable buffer of at most this many bytes plus the signature overlap, so peak scan
+// memory no longer depends on the size of the largest region.
+inline constexpr std::size_t scan_chunk_size = TSPROCESS_SCAN_CHUNK_SIZE;
+
+struct ScanChunk {
+  uintptr_t address;
+  // Bytes owned by this chunk, only matches starting inside them belong to it
+  std::size_t size;
+  // Owned bytes plus the overlap into the following chunk, clipped to the region end
+  std::size_t read_size;
+};
+
+inline std::vector<ScanChunk>
+split_regions(const std::vector<MemoryRegion> &regions, std::size_t overlap, std::size_t chunk_size = scan_chunk_size) {
+  auto chunks = std::vector<ScanChunk>();
+
+  for (const auto &region : regions) {
+    for (std::size_t offset = 0; offset < region.size; offset += chunk_size) {
+      const auto size = std::min(chunk_size, region.size - offset);
+      const auto read_size = std::min(size + overlap, region.size - offset);
 
-      found = false;
-      break;
+      chunks.push_back(ScanChunk{region.address + offset, size, read_size});
     }
+  }
 
-    if (!found) {
-      continue;
+  return chunks;
+}
+
+inline std::size_t chunks_size(const std::vector<ScanChunk> &chunks) {
+  std::size_t size = 0;
+  for (const auto &chunk : chunks) {
+    size += chunk.size;
+  }
+  return size;
+}
+
+class ChunkReader {
+ public:
+  explicit ChunkReader(void *process) : process_(process) {}
+
+  // Returns the chunk bytes, or an empty span if the chunk is unreadable. The span stays valid until the next read.
+  std::span<const uint8_t> read(const ScanChunk &chunk) {
+    if (buffer_.size() < chunk.read_size) {
+      buffer_.resize(chunk.read_size);
+    }
+
+    if (read_buffer(process_, chunk.address, chunk.read_size, buffer_.data())) {
+      return std::span<const uint8_t>(buffer_.data(), chunk.read_size);
+    }
+
+    // The overlap can reach into a page that is not readable, keep at least the owned bytes
+    if (chunk.read_size > chunk.size && read_buffer(process_, chunk.address, chunk.size, buffer_.data())) {
+      return std::span<const uint8_t>(buffer_.data(), chunk.size);
     }
 
-    offset = static_cast<size_t>(i);
-    return true;
+    return {};
   }
 
-  return false;
+ private:
+  void *process_;
+  std::vector<uint8_t> buffer_;
+};
+
+// Limits chunk data to the start positions owned by the chunk, so matches in the overlap are left to the next chunk.
+inline std::span<const uint8_t>
+owned_window(std::span<const uint8_t> data, const ScanChunk &chunk, const scanner::CompiledPattern &pattern) {
+  const auto tail = pattern.empty() ? 0 : pattern.size() - 1;
+  return data.first(std::min(data.size(), chunk.size + tail));
 }
 
-inline uintptr_t
-find_pattern(void *process, const std::vector<uint8_t> signature, const std::vector<uint8_t> mask, bool non_zero_mask) {
-  const auto regions = query_regions(process);
+inline std::size_t signature_overlap(std::size_t signature_size) {
+  return signature_size == 0 ? 0 : signature_size - 1;
+}
 
-  for (auto &region : regions) {
-    auto buffer = std::vector<uint8_t>(region.size);
-    if (!read_buffer(process, region.address, region.size, buffer.data())) {
-      continue;
+inline void atomic_min(std::atomic<uintptr_t> &target, uintptr_t value) {
+  auto current = target.load(std::memory_order_relaxed);
+  while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+// One reader per scan pool participant, indexed by the worker slot a task runs on.
+inline std::vector<ChunkReader> make_readers(void *process) {
+  return std::vector<ChunkReader>(scan_pool::participants(), ChunkReader(process));
+}
+
+constexpr uintptr_t not_found = UINTPTR_MAX;
+
+// Chunks are ordered by address, so once a match is known every chunk at or above it is skipped without being read and
+// the lowest match wins just like in a sequential scan. The scans below only read the regions selected by `filter`, and
+// stop early once `cancel` is set and then only report what was found so far.
+inline uintptr_t find_pattern(
+  void *process,
+  const std::vector<uint8_t> &signature,
+  const std::vector<uint8_t> &mask,
+  bool non_zero_mask,
+  const std::atomic<bool> *cancel = nullptr,
+  const RegionFilter &filter = {}
+) {
+  auto scope = stats::Scope(process, stats::Operation::find_pattern);
+  const auto table = query_regions(process);
+  const auto regions = scan_regions(process, *table, filter);
+  const auto pattern = scanner::CompiledPattern(signature, mask, non_zero_mask);
+  const auto chunks = split_regions(regions, signature_overlap(pattern.size()));
+  scope.add_bytes(chunks_size(chunks));
+
+  auto readers = make_readers(process);
+  auto best = std::atomic<uintptr_t>(not_found);
+
+  const auto task = [&](std::size_t item, std::size_t worker) {
+    const auto &chunk = chunks[item];
+    if (chunk.address >= best.load(std::memory_order_relaxed)) {
+      return;
     }
 
-    size_t offset;
-    if (!scan(buffer, signature, mask, offset, non_zero_mask)) {
-      continue;
+    auto chunk_scope = stats::Scope(process, stats::Operation::scan_chunk, chunk.size, chunk.address);
+    const auto data = readers[worker].read(chunk);
+    if (data.empty()) {
+      chunk_scope.fail();
+      return;
     }
 
-    return region.address + offset;
-  }
+    const auto offset = pattern.find(owned_window(data, chunk, pattern));
+    if (offset == scanner::CompiledPattern::npos) {
+      return;
+    }
+
+    tracer::instant("pattern_hit", process, chunk.address + offset, 0);
+    atomic_min(best, chunk.address + offset);
+  };
 
-  return 0;
+  scan_pool::run(chunks.size(), task, cancel);
+
+  const auto result = best.load();
+  return result == not_found ? 0 : result;
 }
 
-inline std::vector<PatternResult> batch_find_pattern(void *process, std::vector<Pattern> patterns) {
-  const auto regions = query_regions(process);
+// All patterns are matched in one pass over each chunk. First-match patterns keep the lowest address like find_pattern,
+// patterns with `all` set report every match in address order.
+inline std::vector<PatternResult> batch_find_pattern(
+  void *process,
+  std::vector<Pattern> patterns,
+  const std::atomic<bool> *cancel = nullptr,
+  const RegionFilter &filter = {}
+) {
+  auto scope = stats::Scope(process, stats::Operation::batch_find_pattern);
+  const auto table = query_regions(process);
+  const auto regions = scan_regions(process, *table, filter);
 
   auto results = std::vector<PatternResult>();
 
-  for (auto &region : regions) {
-    auto buffer = std::vector<uint8_t>(region.size);
-    if (!read_buffer(process, region.address, region.size, buffer.data())) {
-      continue;
+  auto compiled = std::vector<scanner::CompiledPattern>();
+  compiled.reserve(patterns.size());
+  for (const auto &pattern : patterns) {
+    compiled.emplace_back(pattern.signature, pattern.mask, pattern.non_zero_mask);
+  }
+
+  const auto matcher = scanner::MultiPattern(std::move(compiled));
+  const auto chunks = split_regions(regions, signature_overlap(matcher.max_size()));
+  scope.add_bytes(chunks_size(chunks));
+
+  auto readers = make_readers(process);
+  auto best = std::vector<std::atomic<uintptr_t>>(patterns.size());
+  for (auto &address : best) {
+    address.store(not_found, std::memory_order_relaxed);
+  }
+  // Matches of `all` patterns per chunk, indexed by position in `patterns`
+  auto chunk_matches = std::vector<std::vector<PatternResult>>(chunks.size());
+
+  const auto is_pending = [&](size_t i, uintptr_t address) {
+    if (patterns[i].found) {
+      return false;
     }
 
-    for (auto &pattern : patterns) {
-      if (pattern.found) {
-        continue;
-      }
+    if (patterns[i].all) {
+      return !patterns[i].signature.empty();
+    }
+
+    return address < best[i].load(std::memory_order_relaxed);
+  };
+
+  const auto task = [&](std::size_t item, std::size_t worker) {
+    const auto &chunk = chunks[item];
+
+    auto active = std::vector<uint8_t>(patterns.size());
+    auto pending = false;
+    for (size_t i = 0; i < patterns.size(); ++i) {
+      active[i] = is_pending(i, chunk.address);
+      pending = pending || active[i];
+    }
+
+    // Every pattern already has a match below this chunk
+    if (!pending) {
+      return;
+    }
+
+    auto chunk_scope = stats::Scope(process, stats::Operation::scan_chunk, chunk.size, chunk.address);
+    const auto data = readers[worker].read(chunk);
+    if (data.empty()) {
+      chunk_scope.fail();
+      return;
+    }
 
-      size_t offset;
-      if (!scan(buffer, pattern.signature, pattern.mask, offset, pattern.non_zero_mask)) {
-        continue;
+    matcher.scan(data, chunk.size, active, [&](std::size_t i, std::size_t offset) {
+      const auto address = chunk.address + offset;
+      tracer::instant("pattern_hit", process, address, patterns[i].index);
+      if (patterns[i].all) {
+        chunk_matches[item].push_back(PatternResult{static_cast<int>(i), address});
+        return;
       }
 
-      PatternResult result;
-      result.index = pattern.index;
-      result.address = region.address + offset;
+      // Matches of a pattern arrive in ascending order, the first one is the lowest in this chunk
+      atomic_min(best[i], address);
+      active[i] = 0;
+    });
+  };
 
-      results.push_back(result);
+  scan_pool::run(chunks.size(), task, cancel);
 
-      pattern.found = true;
+  auto all_matches = std::vector<std::vector<uintptr_t>>(patterns.size());
+  for (const auto &matches : chunk_matches) {
+    for (const auto &match : matches) {
+      all_matches[match.index].push_back(match.address);
+    }
+  }
 
-      if (patterns.size() == results.size()) {
-        return results;
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    if (patterns[i].all) {
+      for (const auto address : all_matches[i]) {
+        results.push_back(PatternResult{patterns[i].index, address});
       }
+      continue;
+    }
+
+    const auto address = best[i].load();
+    if (address == not_found) {
+      continue;
     }
+
+    PatternResult result;
+    result.index = patterns[i].index;
+    result.address = address;
+
+    results.push_back(result);
   }
 
   return results;
 }
 
-inline std::vector<uintptr_t>
-find_pattern_all(void *process, const std::vector<uint8_t> signature, const std::vector<uint8_t> mask, bool non_zero_mask) {
-  const auto regions = query_regions(process);
+inline std::vector<uintptr_t> find_pattern_all(
+  void *process,
+  const std::vector<uint8_t> &signature,
+  const std::vector<uint8_t> &mask,
+  bool non_zero_mask,
+  const std::atomic<bool> *cancel = nullptr,
+  const RegionFilter &filter = {}
+) {
+  auto scope = stats::Scope(process, stats::Operation::find_pattern_all);
+  const auto table = query_regions(process);
+  const auto regions = scan_regions(process, *table, filter);
 
   auto results = std::vector<uintptr_t>();
 
@@ -194,37 +530,33 @@ find_pattern_all(void *process, const std::vector<uint8_t> signature, const std:
     return results;
   }
 
-  for (auto &region : regions) {
-    auto buffer = std::vector<uint8_t>(region.size);
-    if (!read_buffer(process, region.address, region.size, buffer.data())) {
-      continue;
+  const auto pattern = scanner::CompiledPattern(signature, mask, non_zero_mask);
+  const auto chunks = split_regions(regions, signature_overlap(pattern.size()));
+  scope.add_bytes(chunks_size(chunks));
+
+  auto readers = make_readers(process);
+  auto chunk_results = std::vector<std::vector<uintptr_t>>(chunks.size());
+
+  const auto task = [&](std::size_t item, std::size_t worker) {
+    const auto &chunk = chunks[item];
+    auto chunk_scope = stats::Scope(process, stats::Operation::scan_chunk, chunk.size, chunk.address);
+    const auto data = owned_window(readers[worker].read(chunk), chunk, pattern);
+    if (data.empty()) {
+      chunk_scope.fail();
     }
 
-    if (buffer.size() < signature.size()) {
-      continue;
+    auto offset = pattern.find(data);
+    while (offset != scanner::CompiledPattern::npos) {
+      tracer::instant("pattern_hit", process, chunk.address + offset, 0);
+      chunk_results[item].push_back(chunk.address + offset);
+      offset = pattern.find(data, offset + 1);
     }
+  };
 
-    for (size_t i = 0; i + signature.size() <= buffer.size(); ++i) {
-      bool found = true;
-      for (size_t j = 0; j < signature.size(); ++j) {
-        if (non_zero_mask) {
-          if ((buffer[i + j] == signature[j] && mask[j] == 1) || (mask[j] == 0 && buffer[i + j] != 0)) {
-            continue;
-          }
-        } else {
-          if (buffer[i + j] == signature[j] || mask[j] == 0) {
-            continue;
-          }
-        }
-
-        found = false;
-        break;
-      }
+  scan_pool::run(chunks.size(), task, cancel);
 
-      if (found) {
-        results.push_back(region.address + i);
-      }
-    }
+  for (const auto &chunk_result : chunk_results) {
+    results.insert(results.end(), chunk_result.begin(), chunk_result.end());
   }
 
   return results;
@@ -1,16 +1,57 @@
 #ifdef __unix__
 #include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/uio.h>
 #include <unistd.h>
 #include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <climits>
 #include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 #include "../logger.h"
+#include "address_map.h"
 #include "memory.h"
+#include "stats.h"
+
+#if __has_include(<linux/fs.h>)
+#include <linux/fs.h>
+#endif
+
+// PROCMAP_QUERY was added in Linux 6.11, older headers miss the uapi even when the running kernel has it
+#ifndef PROCMAP_QUERY
+struct procmap_query {
+  uint64_t size;
+  uint64_t query_flags;
+  uint64_t query_addr;
+  uint64_t vma_start;
+  uint64_t vma_end;
+  uint64_t vma_flags;
+  uint64_t vma_page_size;
+  uint64_t vma_offset;
+  uint64_t inode;
+  uint32_t dev_major;
+  uint32_t dev_minor;
+  uint32_t vma_name_size;
+  uint32_t build_id_size;
+  uint64_t vma_name_addr;
+  uint64_t build_id_addr;
+};
+
+#define PROCMAP_QUERY _IOWR('f', 17, struct procmap_query)
+#define PROCMAP_QUERY_VMA_READABLE 0x01
+#endif
 
 namespace {
 
@@ -23,65 +64,560 @@ std::string read_file(const std::string &path) {
   return "";
 }
 
+#ifndef TSPROCESS_REGION_CACHE_MS
+#define TSPROCESS_REGION_CACHE_MS 1000
+#endif
+
+#ifndef TSPROCESS_VALIDITY_WINDOW_MS
+#define TSPROCESS_VALIDITY_WINDOW_MS 50
+#endif
+
+constexpr auto region_cache_lifetime = std::chrono::milliseconds(TSPROCESS_REGION_CACHE_MS);
+
+constexpr auto validity_window = std::chrono::milliseconds(TSPROCESS_VALIDITY_WINDOW_MS);
+// Kernel lookups of unknown addresses per window, further unknown addresses are rejected until the next window
+constexpr int validity_lookups = 16;
+
+// Appends the whole file to `out` with plain reads, procfs files report a size of 0 so the length is not known upfront.
+bool read_proc_file(const std::string &path, std::string &out) {
+  const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  auto size = out.size();
+  while (true) {
+    if (out.size() - size < 0x1000) {
+      out.resize(std::max<std::size_t>(out.size() * 2, size + 0x4000));
+    }
+
+    const auto count = read(fd, out.data() + size, out.size() - size);
+    stats::count_syscalls();
+    if (count <= 0) {
+      break;
+    }
+    size += static_cast<std::size_t>(count);
+  }
+
+  out.resize(size);
+  close(fd);
+  return true;
+}
+
+// Total program size in pages, the first field of /proc/<pid>/statm, or 0 if the process is gone.
+uint64_t address_space_size(pid_t pid) {
+  const auto path = "/proc/" + std::to_string(pid) + "/statm";
+  const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return 0;
+  }
+
+  char buffer[64];
+  const auto count = read(fd, buffer, sizeof(buffer));
+  close(fd);
+  stats::count_syscalls();
+
+  uint64_t pages = 0;
+  if (count > 0) {
+    std::from_chars(buffer, buffer + count, pages);
+  }
+  return pages;
+}
+
+template <class T>
+bool parse_number(std::string_view &text, T &value, int base) {
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value, base);
+  if (error != std::errc()) {
+    return false;
+  }
+
+  text.remove_prefix(end - text.data());
+  return true;
+}
+
+bool skip(std::string_view &text, char separator) {
+  if (text.empty() || text.front() != separator) {
+    return false;
+  }
+
+  text.remove_prefix(1);
+  return true;
+}
+
+// Parses one /proc/<pid>/maps line: "start-end perms offset major:minor inode   path".
+bool parse_region(std::string_view line, MemoryRegion &region) {
+  uintptr_t end;
+  if (!parse_number(line, region.address, 16) || !skip(line, '-') || !parse_number(line, end, 16) ||
+      !skip(line, ' ') || line.size() < 5 || end < region.address) {
+    return false;
+  }
+  region.size = end - region.address;
+
+  region.protection = (line[0] == 'r' ? MemoryRegion::read : 0) | (line[1] == 'w' ? MemoryRegion::write : 0) |
+                      (line[2] == 'x' ? MemoryRegion::execute : 0);
+  region.shared = line[3] == 's';
+  line.remove_prefix(4);
+
+  if (!skip(line, ' ') || !parse_number(line, region.offset, 16) || !skip(line, ' ')) {
+    return false;
+  }
+
+  const auto device_end = line.find(' ');
+  if (device_end == std::string_view::npos) {
+    return false;
+  }
+  line.remove_prefix(device_end + 1);
+
+  if (!parse_number(line, region.inode, 10)) {
+    return false;
+  }
+
+  const auto path_start = line.find_first_not_of(' ');
+  region.path = path_start == std::string_view::npos ? std::string_view() : line.substr(path_start);
+  region.anonymous = region.inode == 0 && !region.path.starts_with('/');
+  return true;
+}
+
+std::shared_ptr<const RegionTable> parse_maps(pid_t pid) {
+  auto table = std::make_shared<RegionTable>();
+  if (!read_proc_file("/proc/" + std::to_string(pid) + "/maps", table->names)) {
+    return table;
+  }
+
+  const auto text = std::string_view(table->names);
+  table->regions.reserve(std::count(text.begin(), text.end(), '\n'));
+
+  std::size_t position = 0;
+  while (position < text.size()) {
+    auto line_end = text.find('\n', position);
+    if (line_end == std::string_view::npos) {
+      line_end = text.size();
+    }
+
+    MemoryRegion region;
+    if (parse_region(text.substr(position, line_end - position), region)) {
+      table->regions.push_back(region);
+    }
+
+    position = line_end + 1;
+  }
+
+  return table;
+}
+
+// Reads at least this large take part in the automatic backend choice, smaller ones always use process_vm_readv
+constexpr std::size_t large_read_size = 0x10000;
+// Large reads timed with each backend before the automatic choice is made
+constexpr int calibration_reads = 4;
+
+struct Calibration {
+  uint64_t nanoseconds = 0;
+  uint64_t bytes = 0;
+  int reads = 0;
+};
+
+// State behind a handle returned by open_process. The handle value itself stays the pid, so everything that only needs
+// the pid keeps working without a lookup.
+struct ProcessHandle {
+  pid_t pid;
+  // Persistent /proc/<pid>/mem descriptor, -1 if it could not be opened
+  int mem_fd;
+  std::atomic<memory::ReadBackend> backend{memory::ReadBackend::automatic};
+  // Backend picked for large reads in automatic mode, automatic until the calibration is done
+  std::atomic<memory::ReadBackend> large_backend{memory::ReadBackend::automatic};
+
+  std::mutex calibration_mutex;
+  // Indexed by backend - 1
+  std::array<Calibration, 2> calibration;
+
+  // Guards the cached region table, held while it is parsed so concurrent scans share one parse
+  std::mutex regions_mutex;
+  std::shared_ptr<const RegionTable> regions;
+  uint64_t regions_address_space = 0;
+  std::chrono::steady_clock::time_point regions_time;
+
+  // Readable ranges, reads outside of them fail without a syscall
+  address_map::AddressMap readable;
+  // Serializes updates of `readable` and guards the fields below
+  std::mutex readable_mutex;
+  // Cleared when the maps cannot be read, every read is attempted then
+  bool validate = true;
+  // /proc/<pid>/maps descriptor for PROCMAP_QUERY, opened on first use
+  int maps_fd = -1;
+  bool query_supported = true;
+  std::chrono::steady_clock::time_point readable_assigned;
+  std::chrono::steady_clock::time_point lookup_window;
+  int lookups = 0;
+
+  ~ProcessHandle() {
+    if (mem_fd >= 0) {
+      close(mem_fd);
+    }
+    if (maps_fd >= 0) {
+      close(maps_fd);
+    }
+  }
+};
+
+struct Registry {
+  struct Entry {
+    std::shared_ptr<ProcessHandle> handle;
+    int references;
+  };
+
+  std::shared_mutex mutex;
+  std::unordered_map<pid_t, Entry> entries;
+};
+
+Registry &registry() {
+  static auto instance = new Registry();
+  return *instance;
+}
+
+// Handle state of `pid`, null when it was never opened. Readers keep their copy alive across a concurrent close.
+std::shared_ptr<ProcessHandle> find_handle(pid_t pid) {
+  auto &registry = ::registry();
+
+  std::shared_lock lock(registry.mutex);
+  const auto entry = registry.entries.find(pid);
+  return entry == registry.entries.end() ? nullptr : entry->second.handle;
+}
+
+// Adds the readable mappings covering [address, address + size) to `handle.readable`. Returns false if the kernel does
+// not support PROCMAP_QUERY: older kernels reject the ioctl with ENOTTY, kernels that do not know the struct size or a
+// flag with EINVAL.
+bool query_readable(ProcessHandle &handle, uintptr_t address, std::size_t size) {
+  if (handle.maps_fd < 0) {
+    const auto path = "/proc/" + std::to_string(handle.pid) + "/maps";
+    handle.maps_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (handle.maps_fd < 0) {
+      return false;
+    }
+  }
+
+  const auto end = address + size;
+  for (auto position = address; position < end;) {
+    procmap_query query{};
+    query.size = sizeof(query);
+    query.query_flags = PROCMAP_QUERY_VMA_READABLE;
+    query.query_addr = position;
+
+    stats::count_syscalls();
+    if (ioctl(handle.maps_fd, PROCMAP_QUERY, &query) != 0) {
+      // ENOENT: nothing readable is mapped there
+      return errno != ENOTTY && errno != EINVAL;
+    }
+
+    handle.readable.insert(static_cast<uintptr_t>(query.vma_start), static_cast<uintptr_t>(query.vma_end));
+    position = static_cast<uintptr_t>(query.vma_end);
+  }
+
+  return true;
+}
+
+void assign_readable(ProcessHandle &handle, const RegionTable &table) {
+  handle.readable.assign(table);
+  handle.readable_assigned = std::chrono::steady_clock::now();
+  handle.validate = !table.regions.empty();
+}
+
+// Whether [address, address + size) is mapped readable as far as the handle knows. The ranges start out as a full maps
+// parse and are extended by looking up unknown addresses with PROCMAP_QUERY, or parsing the maps again on kernels
+// without it. Lookups are limited per window, so a stale offset chasing garbage pointers costs a few syscalls per
+// window instead of a failed read each time. A new mapping can be rejected for up to one window.
+bool is_known_readable(ProcessHandle &handle, uintptr_t address, std::size_t size) {
+  if (size == 0 || handle.readable.contains(address, size)) {
+    return true;
+  }
+
+  std::lock_guard lock(handle.readable_mutex);
+  if (!handle.validate || handle.readable.contains(address, size)) {
+    return true;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  if (now - handle.lookup_window >= validity_window) {
+    handle.lookup_window = now;
+    handle.lookups = 0;
+  }
+
+  if (handle.lookups >= validity_lookups) {
+    return false;
+  }
+  handle.lookups += 1;
+
+  // Lookups only ever add ranges, a periodic full parse drops the ones that were unmapped since
+  auto parse = handle.readable.empty() || now - handle.readable_assigned >= region_cache_lifetime;
+  if (!parse && handle.query_supported && !query_readable(handle, address, size)) {
+    handle.query_supported = false;
+  }
+
+  if (parse || !handle.query_supported) {
+    assign_readable(handle, *parse_maps(handle.pid));
+    // Without PROCMAP_QUERY every lookup is a full parse, allow one per window
+    if (!handle.query_supported) {
+      handle.lookups = validity_lookups;
+    }
+  }
+
+  return !handle.validate || handle.readable.contains(address, size);
+}
+
+pid_t handle_pid(void *process) {
+  return static_cast<pid_t>(reinterpret_cast<uintptr_t>(process));
+}
+
+bool read_vm(pid_t pid, uintptr_t address, std::size_t size, uint8_t *buffer) {
+  iovec local_iov{buffer, size};
+  iovec remote_iov{reinterpret_cast<void *>(address), size};
+
+  stats::count_syscalls();
+  return process_vm_readv(pid, &local_iov, 1, &remote_iov, 1, 0) == static_cast<ssize_t>(size);
+}
+
+bool read_mem(int fd, uintptr_t address, std::size_t size, uint8_t *buffer) {
+  stats::count_syscalls();
+  return pread(fd, buffer, size, static_cast<off_t>(address)) == static_cast<ssize_t>(size);
+}
+
+bool read_with(
+  const ProcessHandle *handle,
+  pid_t pid,
+  memory::ReadBackend backend,
+  uintptr_t address,
+  std::size_t size,
+  uint8_t *buffer
+) {
+  if (backend == memory::ReadBackend::proc_mem) {
+    return read_mem(handle->mem_fd, address, size, buffer);
+  }
+
+  return read_vm(pid, address, size, buffer);
+}
+
+// Backend a read of `size` bytes goes through, automatic means it is used to calibrate.
+memory::ReadBackend pick_backend(const ProcessHandle *handle, std::size_t size) {
+  if (handle == nullptr || handle->mem_fd < 0) {
+    return memory::ReadBackend::vm_readv;
+  }
+
+  const auto backend = handle->backend.load(std::memory_order_relaxed);
+  if (backend != memory::ReadBackend::automatic) {
+    return backend;
+  }
+
+  if (size < large_read_size) {
+    return memory::ReadBackend::vm_readv;
+  }
+
+  return handle->large_backend.load(std::memory_order_relaxed);
+}
+
+// Times a large read with whichever backend has fewer samples. Once both have enough of them the one with the lower
+// cost per byte is kept for every following large read. A backend that fails where the other one succeeds loses
+// right away, so a /proc/<pid>/mem that cannot be read never costs more than one extra syscall.
+bool calibrate(ProcessHandle &handle, uintptr_t address, std::size_t size, uint8_t *buffer) {
+  std::size_t index;
+  {
+    std::lock_guard lock(handle.calibration_mutex);
+    index = handle.calibration[0].reads <= handle.calibration[1].reads ? 0 : 1;
+  }
+
+  const auto backend = static_cast<memory::ReadBackend>(index + 1);
+  const auto other = static_cast<memory::ReadBackend>(2 - index);
+
+  const auto start = std::chrono::steady_clock::now();
+  if (!read_with(&handle, handle.pid, backend, address, size, buffer)) {
+    const auto success = read_with(&handle, handle.pid, other, address, size, buffer);
+    if (success) {
+      handle.large_backend.store(other, std::memory_order_relaxed);
+    }
+    return success;
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  std::lock_guard lock(handle.calibration_mutex);
+  auto &sample = handle.calibration[index];
+  sample.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  sample.bytes += size;
+  sample.reads += 1;
+
+  const auto &vm = handle.calibration[0];
+  const auto &mem = handle.calibration[1];
+  if (vm.reads >= calibration_reads && mem.reads >= calibration_reads) {
+    const auto mem_faster = mem.nanoseconds * vm.bytes < vm.nanoseconds * mem.bytes;
+    handle.large_backend.store(
+      mem_faster ? memory::ReadBackend::proc_mem : memory::ReadBackend::vm_readv, std::memory_order_relaxed
+    );
+  }
+
+  return true;
+}
+
 }  // namespace
 
 std::vector<uint32_t> memory::find_processes(const std::vector<std::string> &process_names) {
+  // comm of every pid seen in the previous walks, keyed by the inode of its /proc entry so a recycled pid is read again.
+  // An exec or PR_SET_NAME keeps pid and inode, which is how the Wine preloader becomes osu!.exe and an AppImage
+  // AppRun becomes osu!, so names that did not match are read again until the process was known for a while.
+  struct CachedProcess {
+    ino_t inode;
+    std::string comm;
+    std::chrono::steady_clock::time_point first_seen;
+    bool seen;
+  };
+  constexpr auto comm_settle_time = std::chrono::seconds(30);
+  static std::mutex mutex;
+  static std::unordered_map<uint32_t, CachedProcess> cache;
+
+  std::lock_guard lock(mutex);
+  const auto now = std::chrono::steady_clock::now();
+
+  for (auto &[pid, process] : cache) {
+    process.seen = false;
+  }
+
   std::vector<uint32_t> process_ids;
   const auto dir = opendir("/proc");
   if (dir) {
     dirent *entry;
     while ((entry = readdir(dir)) != nullptr) {
-      if (entry->d_type == DT_DIR) {
-        std::string pid_str(entry->d_name);
-        if (std::all_of(pid_str.begin(), pid_str.end(), isdigit)) {
-          const auto pid = std::stoi(pid_str);
-          const auto cmdline_path = "/proc/" + pid_str + "/comm";
-          const auto cmdline = read_file(cmdline_path);
-          if (cmdline.empty()) {
-            continue;
-          }
-          // Check if the process name matches any in the provided list
-          for (const auto &process_name : process_names) {
-            if (cmdline.find(process_name) != std::string::npos) {
-              process_ids.push_back(pid);
-            }
-          }
-        }
+      if (entry->d_type != DT_DIR) {
+        continue;
+      }
+
+      const auto name = std::string_view(entry->d_name);
+      uint32_t pid;
+      const auto [end, error] = std::from_chars(name.data(), name.data() + name.size(), pid);
+      if (error != std::errc() || end != name.data() + name.size()) {
+        continue;
+      }
+
+      const auto matches = [&process_names](const std::string &comm) {
+        return std::any_of(process_names.begin(), process_names.end(), [&comm](const auto &process_name) {
+          return comm.find(process_name) != std::string::npos;
+        });
+      };
+
+      auto &process = cache[pid];
+      if (process.comm.empty() || process.inode != entry->d_ino) {
+        process.inode = entry->d_ino;
+        process.first_seen = now;
+        process.comm = read_file("/proc/" + std::string(name) + "/comm");
+      } else if (now - process.first_seen < comm_settle_time && !matches(process.comm)) {
+        process.comm = read_file("/proc/" + std::string(name) + "/comm");
+      }
+      process.seen = true;
+
+      if (!process.comm.empty() && matches(process.comm)) {
+        process_ids.push_back(pid);
       }
     }
     closedir(dir);
   }
+
+  std::erase_if(cache, [](const auto &item) { return !item.second.seen; });
+
   return process_ids;
 }
 
 void *memory::open_process(uint32_t id) {
+  auto &registry = ::registry();
+  const auto pid = static_cast<pid_t>(id);
+
+  std::lock_guard lock(registry.mutex);
+  auto &entry = registry.entries[pid];
+  if (entry.references++ == 0) {
+    const auto path = "/proc/" + std::to_string(id) + "/mem";
+
+    entry.handle = std::make_shared<ProcessHandle>();
+    entry.handle->pid = pid;
+    entry.handle->mem_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  }
+
   return reinterpret_cast<void *>(id);
 }
 
 void memory::close_handle(void *handle) {
-  // do nothing
+  auto &registry = ::registry();
+
+  std::lock_guard lock(registry.mutex);
+  const auto entry = registry.entries.find(handle_pid(handle));
+  if (entry != registry.entries.end() && --entry->second.references == 0) {
+    registry.entries.erase(entry);
+  }
 }
 
-bool memory::is_process_exist(void *process) {
-  const auto pid = reinterpret_cast<uintptr_t>(process);
-  struct stat sts;
-  const auto proc_path = "/proc/" + std::to_string(pid);
-  if (stat(proc_path.c_str(), &sts) == -1 && errno == ENOENT) {
+bool memory::set_read_backend(void *process, ReadBackend backend) {
+  const auto handle = find_handle(handle_pid(process));
+  if (handle == nullptr) {
     return false;
   }
+
+  if (backend == ReadBackend::proc_mem && handle->mem_fd < 0) {
+    return false;
+  }
+
+  handle->backend.store(backend, std::memory_order_relaxed);
   return true;
 }
 
+memory::ReadBackend memory::get_read_backend(void *process) {
+  const auto handle = find_handle(handle_pid(process));
+  if (handle == nullptr || handle->mem_fd < 0) {
+    return ReadBackend::vm_readv;
+  }
+
+  const auto backend = handle->backend.load(std::memory_order_relaxed);
+  return backend == ReadBackend::automatic ? handle->large_backend.load(std::memory_order_relaxed) : backend;
+}
+
+bool memory::is_process_exist(void *process) {
+  const auto pid = static_cast<pid_t>(reinterpret_cast<uintptr_t>(process));
+  // EPERM still means there is a process with that pid, owned by someone else
+  return kill(pid, 0) == 0 || errno == EPERM;
+}
+
 // Returns the process creation time as unix epoch milliseconds, or 0 on failure.
-// /proc/<pid> is created when the process starts, so its ctime approximates it.
+// Field 22 of /proc/<pid>/stat is the start time in clock ticks after boot, btime in /proc/stat is the boot time.
 uint64_t memory::get_process_start_time(void *process) {
   const auto pid = reinterpret_cast<uintptr_t>(process);
-  struct stat sts;
-  const auto proc_path = "/proc/" + std::to_string(pid);
-  if (stat(proc_path.c_str(), &sts) != 0) {
+  const auto stat = read_file("/proc/" + std::to_string(pid) + "/stat");
+
+  // The command name in field 2 may contain spaces and parentheses, the fields after it start behind the last ')'
+  const auto name_end = stat.rfind(')');
+  if (name_end == std::string::npos) {
+    return 0;
+  }
+
+  auto position = name_end + 1;
+  for (int field = 3; field < 22 && position != std::string::npos; ++field) {
+    position = stat.find(' ', position + 1);
+  }
+  if (position == std::string::npos) {
+    return 0;
+  }
+
+  uint64_t start_ticks = 0;
+  std::from_chars(stat.data() + position + 1, stat.data() + stat.size(), start_ticks);
+
+  static const auto boot_time = [] {
+    const auto system_stat = read_file("/proc/stat");
+    const auto line = system_stat.find("\nbtime ");
+    uint64_t seconds = 0;
+    if (line != std::string::npos) {
+      const auto value = system_stat.data() + line + 7;
+      std::from_chars(value, system_stat.data() + system_stat.size(), seconds);
+    }
+    return seconds;
+  }();
+
+  const auto ticks_per_second = static_cast<uint64_t>(sysconf(_SC_CLK_TCK));
+  if (boot_time == 0 || ticks_per_second == 0) {
     return 0;
   }
-  return static_cast<uint64_t>(sts.st_ctime) * 1000ULL;
+
+  return boot_time * 1000ULL + start_ticks * 1000ULL / ticks_per_second;
 }
 
 bool memory::is_process_64bit(uint32_t id) {
@@ -147,54 +683,261 @@ std::string memory::get_process_cwd(void *process) {
 }
 
 bool memory::read_buffer(void *process, uintptr_t address, std::size_t size, uint8_t *buffer) {
-  const auto pid = reinterpret_cast<uintptr_t>(process);
-
-  iovec local_iov{buffer, size};
-  iovec remote_iov{reinterpret_cast<void *>(address), size};
+  auto scope = stats::Scope(process, stats::Operation::read, size, address);
+  const auto pid = handle_pid(process);
+  const auto handle = find_handle(pid);
 
-  const auto result_size = process_vm_readv(pid, &local_iov, 1, &remote_iov, 1, 0);
+  if (handle != nullptr && size < large_read_size && !is_known_readable(*handle, address, size)) {
+    scope.fail();
+    errno = EFAULT;
+    return false;
+  }
 
-  const auto success = result_size == size;
+  const auto backend = pick_backend(handle.get(), size);
+  const auto success = backend == ReadBackend::automatic ? calibrate(*handle, address, size, buffer)
+                                                         : read_with(handle.get(), pid, backend, address, size, buffer);
+  if (!success) {
+    scope.fail();
+  }
 
   if (!success && errno == EPERM) {
-    logger::println("failed to read address {:x} of size {:x}", address, size);
-    logger::println("Consider running with sudo or using setcap:");
-    logger::println("  sudo /path/to/tosu");
-    logger::println("  sudo setcap cap_sys_ptrace=eip /path/to/tosu");
+    logger::warn("failed to read address {:x} of size {:x}", address, size);
+    logger::warn("Consider running with sudo or using setcap:");
+    logger::warn("  sudo /path/to/tosu");
+    logger::warn("  sudo setcap cap_sys_ptrace=eip /path/to/tosu");
+    // Kept for memory::read_failure, starting the logger thread may overwrite it
+    errno = EPERM;
   }
 
   return success;
 }
 
-std::vector<MemoryRegion> memory::query_regions(void *process) {
-  std::vector<MemoryRegion> regions;
+memory::ReadStatus memory::read_failure(void *process, uintptr_t address, std::size_t size) {
+  const auto error = errno;
+  if (address >= null_region_size && (error == EPERM || error == EACCES)) {
+    return ReadStatus::permission;
+  }
 
-  const auto pid = reinterpret_cast<uintptr_t>(process);
-  const auto maps_path = "/proc/" + std::to_string(pid) + "/maps";
-  std::ifstream maps_file(maps_path);
-  if (!maps_file.is_open()) {
-    return regions;
+  return unreadable_status(process, address, size);
+}
+
+std::size_t memory::read_batch(void *process, std::span<const ReadRequest> requests, uint8_t *buffer, uint8_t *success) {
+  auto scope = stats::Scope(process, stats::Operation::read_batch);
+  const auto pid = handle_pid(process);
+
+  std::fill_n(success, (requests.size() + 7) / 8, 0);
+
+  // preadv only scatters into local memory, the remote side has to be read one request at a time
+  const auto handle = find_handle(pid);
+  if (pick_backend(handle.get(), 0) == ReadBackend::proc_mem) {
+    std::size_t succeeded = 0;
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+      const auto &request = requests[i];
+      const auto valid = is_known_readable(*handle, request.address, request.size);
+      if (valid && read_mem(handle->mem_fd, request.address, request.size, buffer + offset)) {
+        success[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+        ++succeeded;
+      }
+      offset += request.size;
+    }
+
+    scope.add_bytes(offset);
+    if (succeeded < requests.size()) {
+      scope.fail();
+    }
+    return succeeded;
   }
 
-  std::string line;
-  while (std::getline(maps_file, line)) {
-    MemoryRegion region;
+  auto remote_iov = std::vector<iovec>();
+  remote_iov.reserve(std::min<std::size_t>(requests.size(), IOV_MAX));
+
+  std::size_t succeeded = 0;
+  std::size_t offset = 0;
+  std::size_t next = 0;
+
+  const auto mark = [&](std::size_t index) {
+    success[index / 8] |= static_cast<uint8_t>(1u << (index % 8));
+    ++succeeded;
+  };
+
+  const auto valid = [&](const ReadRequest &request) {
+    return handle == nullptr || is_known_readable(*handle, request.address, request.size);
+  };
+
+  // The kernel stops at the first remote element it cannot read, so every failure costs one extra syscall that resumes
+  // right after the failed request. Requests known to be unmapped end a group without being sent and are skipped, which
+  // saves that syscall. Data keeps its place in the buffer either way.
+  while (next < requests.size()) {
+    const auto first = next;
+    const auto first_offset = offset;
+    std::size_t group_size = 0;
+    auto skip_next = false;
+
+    remote_iov.clear();
+    for (; next < requests.size() && remote_iov.size() < IOV_MAX; ++next) {
+      const auto &request = requests[next];
+      if (request.size == 0) {
+        continue;
+      }
 
-    const auto first_space_pos = line.find(' ');
-    const auto address_range = line.substr(0, first_space_pos);
+      if (!valid(request)) {
+        skip_next = true;
+        break;
+      }
+
+      remote_iov.push_back(iovec{reinterpret_cast<void *>(request.address), request.size});
+      group_size += request.size;
+    }
 
-    const auto dash_pos = address_range.find('-');
-    region.address = std::stoull(address_range.substr(0, dash_pos), nullptr, 16);
-    const auto end_address = std::stoull(address_range.substr(dash_pos + 1), nullptr, 16);
-    region.size = end_address - region.address;
-    const auto protections = line.substr(first_space_pos + 1, 5);
+    iovec local_iov{buffer + first_offset, group_size};
 
-    if (protections[0] == 'r' && protections[1] == 'w') {
-      regions.push_back(region);
+    stats::count_syscalls(remote_iov.empty() ? 0 : 1);
+    const auto read_size =
+      remote_iov.empty() ? 0 : process_vm_readv(pid, &local_iov, 1, remote_iov.data(), remote_iov.size(), 0);
+    if (read_size < 0 && errno == ESRCH) {
+      break;
     }
+
+    auto remaining = read_size > 0 ? static_cast<std::size_t>(read_size) : 0;
+
+    for (auto index = first; index < next; ++index) {
+      const auto size = requests[index].size;
+      if (remaining < size) {
+        // Request `index` failed, everything after it has to be read again
+        offset += size;
+        next = index + 1;
+        skip_next = false;
+        break;
+      }
+
+      remaining -= size;
+      offset += size;
+      mark(index);
+    }
+
+    if (skip_next) {
+      offset += requests[next].size;
+      next += 1;
+    }
+  }
+
+  scope.add_bytes(offset);
+  if (succeeded < requests.size()) {
+    scope.fail();
+  }
+  return succeeded;
+}
+
+std::vector<MemoryRegion>
+memory::populated_regions(void *process, std::vector<MemoryRegion> regions, const RegionFilter &filter) {
+  if (!filter.skip_unpopulated && !filter.resident_only) {
+    return regions;
+  }
+
+  const auto path = "/proc/" + std::to_string(handle_pid(process)) + "/pagemap";
+  const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return regions;
+  }
+
+  constexpr uint64_t present_bit = 1ULL << 63;
+  constexpr uint64_t swapped_bit = 1ULL << 62;
+  // Pagemap entries read per syscall, 512KiB covering 256MiB of address space
+  constexpr std::size_t block_pages = 0x10000;
+
+  const auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  auto entries = std::vector<uint64_t>();
+  auto result = std::vector<MemoryRegion>();
+  result.reserve(regions.size());
+
+  for (const auto &region : regions) {
+    // Untouched pages of file mappings hold file contents, they only go with resident_only
+    if (!filter.resident_only && !region.anonymous) {
+      result.push_back(region);
+      continue;
+    }
+
+    const auto end = region.address + region.size;
+    const auto first_page = region.address / page_size;
+    const auto page_count = (end - 1) / page_size - first_page + 1;
+
+    // Start of the run of kept pages being built, `end` when there is none
+    auto run_start = end;
+    const auto close_run = [&](uintptr_t run_end) {
+      if (run_start < run_end) {
+        auto run = region;
+        run.address = run_start;
+        run.size = run_end - run_start;
+        result.push_back(run);
+      }
+      run_start = end;
+    };
+
+    for (std::size_t block = 0; block < page_count; block += block_pages) {
+      const auto count = std::min(block_pages, page_count - block);
+      entries.resize(count);
+
+      const auto bytes = count * sizeof(uint64_t);
+      const auto offset = static_cast<off_t>((first_page + block) * sizeof(uint64_t));
+      const auto read_all = pread(fd, entries.data(), bytes, offset) == static_cast<ssize_t>(bytes);
+      stats::count_syscalls();
+
+      for (std::size_t i = 0; i < count; ++i) {
+        const auto page = (first_page + block + i) * page_size;
+        const auto flags = entries[i];
+        const auto keep = !read_all || (flags & present_bit) != 0 || (!filter.resident_only && (flags & swapped_bit) != 0);
+
+        if (keep && run_start == end) {
+          run_start = std::max(page, region.address);
+        } else if (!keep) {
+          close_run(std::max(page, region.address));
+        }
+      }
+    }
+
+    close_run(end);
+  }
+
+  close(fd);
+  return result;
+}
+
+bool memory::is_readable(void *process, uintptr_t address, std::size_t size) {
+  const auto pid = handle_pid(process);
+  const auto handle = find_handle(pid);
+  if (handle != nullptr) {
+    return is_known_readable(*handle, address, size);
+  }
+
+  auto readable = address_map::AddressMap();
+  readable.assign(*parse_maps(pid));
+  return readable.contains(address, size);
+}
+
+std::shared_ptr<const RegionTable> memory::query_regions(void *process) {
+  const auto scope = stats::Scope(process, stats::Operation::query_regions);
+  const auto pid = handle_pid(process);
+  const auto handle = find_handle(pid);
+  if (handle == nullptr) {
+    return parse_maps(pid);
+  }
+
+  const auto address_space = address_space_size(pid);
+  const auto now = std::chrono::steady_clock::now();
+
+  std::lock_guard lock(handle->regions_mutex);
+  if (handle->regions == nullptr || address_space == 0 || address_space != handle->regions_address_space ||
+      now - handle->regions_time >= region_cache_lifetime) {
+    handle->regions = parse_maps(pid);
+    handle->regions_address_space = address_space;
+    handle->regions_time = now;
+
+    std::lock_guard readable_lock(handle->readable_mutex);
+    assign_readable(*handle, *handle->regions);
   }
 
-  return regions;
+  return handle->regions;
 }
 
 void *memory::get_foreground_window_process() {
@@ -8,31 +8,200 @@
 #include <tlhelp32.h>
 #include <winnt.h>
 #include <winternl.h>
-#include <iostream>
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
+#include "../logger.h"
 #include "memory.h"
+#include "stats.h"
 
 #pragma comment(lib, "Psapi.lib")
 #pragma comment(lib, "ntdll.lib")
 
-bool memory::read_buffer(void *process, uintptr_t address, std::size_t size, uint8_t *buffer) {
+namespace {
+
+bool read_memory(void *process, uintptr_t address, std::size_t size, uint8_t *buffer) {
+  stats::count_syscalls();
   return ReadProcessMemory(process, reinterpret_cast<void *>(address), buffer, size, 0) == 1;
 }
 
-std::vector<MemoryRegion> memory::query_regions(void *process) {
-  std::vector<MemoryRegion> regions;
+// NT device of every drive letter paired with the letter, such as \Device\HarddiskVolume3 and C:
+std::vector<std::pair<std::string, std::string>> drive_devices() {
+  auto devices = std::vector<std::pair<std::string, std::string>>();
+
+  char drives[512];
+  const auto length = GetLogicalDriveStringsA(sizeof(drives) - 1, drives);
+  if (length == 0 || length >= sizeof(drives)) {
+    return devices;
+  }
+
+  // The drives come as "C:\" strings, each terminated by a null character, with an empty one at the end
+  for (const char *drive = drives; *drive != 0; drive += std::strlen(drive) + 1) {
+    const auto letter = std::string(drive, 2);
+    char device[MAX_PATH];
+    if (QueryDosDeviceA(letter.c_str(), device, sizeof(device)) != 0) {
+      devices.emplace_back(device, letter);
+    }
+  }
+
+  return devices;
+}
+
+// GetMappedFileName reports NT device paths, region paths use the drive letter so filters can be written against the
+// usual paths. Paths on devices without a drive letter are kept as they are.
+std::string dos_path(std::string_view path, const std::vector<std::pair<std::string, std::string>> &devices) {
+  for (const auto &[device, letter] : devices) {
+    if (path.size() > device.size() && path.starts_with(device) && path[device.size()] == '\\') {
+      return letter + std::string(path.substr(device.size()));
+    }
+  }
+
+  return std::string(path);
+}
+
+}  // namespace
+
+bool memory::read_buffer(void *process, uintptr_t address, std::size_t size, uint8_t *buffer) {
+  auto scope = stats::Scope(process, stats::Operation::read, size, address);
+  const auto success = read_memory(process, address, size, buffer);
+  if (!success) {
+    scope.fail();
+  }
+
+  return success;
+}
+
+memory::ReadStatus memory::read_failure(void *process, uintptr_t address, std::size_t size) {
+  const auto error = GetLastError();
+  if (address >= null_region_size && error == ERROR_ACCESS_DENIED) {
+    return ReadStatus::permission;
+  }
+
+  return unreadable_status(process, address, size);
+}
+
+std::size_t memory::read_batch(void *process, std::span<const ReadRequest> requests, uint8_t *buffer, uint8_t *success) {
+  auto scope = stats::Scope(process, stats::Operation::read_batch);
+  std::fill_n(success, (requests.size() + 7) / 8, 0);
+
+  std::size_t succeeded = 0;
+  std::size_t offset = 0;
+
+  for (std::size_t i = 0; i < requests.size(); ++i) {
+    const auto &request = requests[i];
+    if (request.size == 0 || read_memory(process, request.address, request.size, buffer + offset)) {
+      success[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+      ++succeeded;
+    }
+
+    offset += request.size;
+  }
+
+  scope.add_bytes(offset);
+  if (succeeded < requests.size()) {
+    scope.fail();
+  }
+  return succeeded;
+}
+
+namespace {
+
+uint8_t region_protection(DWORD protect) {
+  if ((protect & (PAGE_NOACCESS | PAGE_GUARD)) != 0) {
+    return 0;
+  }
+
+  // Copy-on-write pages count as read-only, like before regions carried their protection
+  switch (protect & 0xff) {
+    case PAGE_READONLY:
+    case PAGE_WRITECOPY:
+      return MemoryRegion::read;
+    case PAGE_READWRITE:
+      return MemoryRegion::read | MemoryRegion::write;
+    case PAGE_EXECUTE_READ:
+    case PAGE_EXECUTE_WRITECOPY:
+      return MemoryRegion::read | MemoryRegion::execute;
+    case PAGE_EXECUTE_READWRITE:
+      return MemoryRegion::read | MemoryRegion::write | MemoryRegion::execute;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+std::vector<MemoryRegion>
+memory::populated_regions(void *process, std::vector<MemoryRegion> regions, const RegionFilter &filter) {
+  return regions;
+}
+
+bool memory::is_readable(void *process, uintptr_t address, std::size_t size) {
+  const auto end = address + size;
+
+  MEMORY_BASIC_INFORMATION info;
+  for (auto position = address; position < end; position = reinterpret_cast<uintptr_t>(info.BaseAddress) + info.RegionSize) {
+    if (VirtualQueryEx(process, reinterpret_cast<void *>(position), &info, sizeof(info)) == 0) {
+      return false;
+    }
+
+    if ((info.State & MEM_COMMIT) == 0 || region_protection(info.Protect) == 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::shared_ptr<const RegionTable> memory::query_regions(void *process) {
+  const auto scope = stats::Scope(process, stats::Operation::query_regions);
+  auto table = std::make_shared<RegionTable>();
+  // Offset and length of each region's mapped file name in `names`, the views are made once it stops growing
+  auto names = std::vector<std::pair<std::size_t, std::size_t>>();
+  const auto devices = drive_devices();
 
   MEMORY_BASIC_INFORMATION info;
   for (uint8_t *address = 0; VirtualQueryEx(process, address, &info, sizeof(info)) != 0; address += info.RegionSize) {
-    if ((info.State & MEM_COMMIT) == 0 || (info.Protect & (PAGE_READWRITE | PAGE_EXECUTE_READWRITE)) == 0) {
+    stats::count_syscalls();
+    if ((info.State & MEM_COMMIT) == 0) {
+      continue;
+    }
+
+    const auto protection = region_protection(info.Protect);
+    if (protection == 0) {
       continue;
     }
 
-    regions.push_back(MemoryRegion{reinterpret_cast<uintptr_t>(info.BaseAddress), info.RegionSize});
+    auto name = std::make_pair(table->names.size(), std::size_t(0));
+    if (info.Type != MEM_PRIVATE) {
+      char path[MAX_PATH];
+      const auto length = GetMappedFileNameA(process, info.BaseAddress, path, sizeof(path));
+      stats::count_syscalls();
+      const auto mapped = dos_path(std::string_view(path, length), devices);
+      table->names.append(mapped);
+      name.second = mapped.size();
+    }
+    names.push_back(name);
+
+    table->regions.push_back(MemoryRegion{
+      reinterpret_cast<uintptr_t>(info.BaseAddress),
+      info.RegionSize,
+      protection,
+      info.Type == MEM_MAPPED,
+      info.Type == MEM_PRIVATE,
+      0,
+      0,
+      {}
+    });
   }
 
-  return regions;
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    table->regions[i].path = std::string_view(table->names).substr(names[i].first, names[i].second);
+  }
+
+  return table;
 }
 
 std::vector<uint32_t> memory::find_processes(const std::vector<std::string> &process_names) {
@@ -65,6 +234,14 @@ void memory::close_handle(void *handle) {
   CloseHandle(handle);
 }
 
+bool memory::set_read_backend(void *process, ReadBackend backend) {
+  return backend == ReadBackend::automatic;
+}
+
+memory::ReadBackend memory::get_read_backend(void *process) {
+  return ReadBackend::automatic;
+}
+
 bool memory::is_process_exist(void *handle) {
   DWORD returnCode{};
   if (GetExitCodeProcess(handle, &returnCode)) {
@@ -100,7 +277,7 @@ bool memory::is_process_64bit(uint32_t id) {
 
   if (!IsWow64Process(process_handle, &is_wow64)) {
     DWORD error = GetLastError();
-    std::cerr << "Failed to determine process bitness, error: " << error << std::endl;
+    logger::error("Failed to determine process bitness, error: {}", error);
     return false;
   }
 
@@ -131,23 +308,23 @@ std::string memory::get_process_command_line(void *process) {
   PROCESS_BASIC_INFORMATION pbi = {};
   NTSTATUS status = NtQueryInformationProcess(process, ProcessBasicInformation, &pbi, sizeof(pbi), NULL);
   if (status != 0) {
-    std::cerr << "failed to query the process, error: " << status << std::endl;
+    logger::error("failed to query the process, error: {}", status);
   } else {
     PEB peb = {};
     if (!ReadProcessMemory(process, pbi.PebBaseAddress, &peb, sizeof(peb), NULL)) {
       DWORD err = GetLastError();
-      std::cerr << "failed to read the process PEB, error: " << err << std::endl;
+      logger::error("failed to read the process PEB, error: {}", err);
     } else {
       RTL_USER_PROCESS_PARAMETERS params = {};
       if (!ReadProcessMemory(process, peb.ProcessParameters, &params, sizeof(params), NULL)) {
         DWORD err = GetLastError();
-        std::cerr << "failed to read the process params, error: " << err << std::endl;
+        logger::error("failed to read the process params, error: {}", err);
       } else {
         UNICODE_STRING &commandLineArgs = params.CommandLine;
         std::vector<WCHAR> buffer(commandLineArgs.Length / sizeof(WCHAR));
         if (!ReadProcessMemory(process, commandLineArgs.Buffer, buffer.data(), commandLineArgs.Length, NULL)) {
           DWORD err = GetLastError();
-          std::cerr << "failed to read the process command line, error: " << err << std::endl;
+          logger::error("failed to read the process command line, error: {}", err);
         } else {
           commandLine = std::string(buffer.begin(), buffer.end());
         }
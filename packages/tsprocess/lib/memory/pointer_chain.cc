@@ -0,0 +1,244 @@
+#include "pointer_chain.h"
+
+#include <cstring>
+#include <unordered_map>
+#include "memory.h"
+
+namespace {
+
+constexpr uint32_t no_parent = UINT32_MAX;
+
+// Leaves reading a pointer share the key of the link at the same position, so `[[a + 4] + 8]` as a value and as a
+// prefix of a longer chain is only read once.
+constexpr uint8_t link_kind = 0xff;
+
+struct NodeKey {
+  uint32_t parent;
+  uint8_t size;
+  uint8_t kind;
+  int64_t offset;
+
+  bool operator==(const NodeKey &other) const = default;
+};
+
+struct NodeKeyHash {
+  std::size_t operator()(const NodeKey &key) const {
+    auto hash = static_cast<uint64_t>(key.offset) * 0x9e3779b97f4a7c15ULL;
+    hash ^= (static_cast<uint64_t>(key.parent) << 16) | (static_cast<uint64_t>(key.size) << 8) | key.kind;
+    return static_cast<std::size_t>(hash ^ (hash >> 29));
+  }
+};
+
+struct Node {
+  uint32_t parent;
+  int64_t offset;
+  uint8_t size;
+  uint8_t kind;
+  // Address the node points to for links, the raw value for leaves
+  uint64_t value;
+  pointer_chain::Status status;
+};
+
+struct Scratch {
+  std::vector<Node> nodes;
+  std::vector<std::vector<uint32_t>> levels;
+  std::unordered_map<NodeKey, uint32_t, NodeKeyHash> index;
+  std::vector<uint32_t> leaves;
+  std::vector<ReadRequest> requests;
+  std::vector<uint32_t> requested;
+  std::vector<uint8_t> buffer;
+  std::vector<uint8_t> success;
+
+  void clear() {
+    nodes.clear();
+    for (auto &level : levels) {
+      level.clear();
+    }
+    index.clear();
+    leaves.clear();
+  }
+};
+
+uint32_t intern(Scratch &scratch, const NodeKey &key, std::size_t depth) {
+  const auto [it, inserted] = scratch.index.try_emplace(key, static_cast<uint32_t>(scratch.nodes.size()));
+  if (!inserted) {
+    return it->second;
+  }
+
+  scratch.nodes.push_back(Node{key.parent, key.offset, key.size, key.kind, 0, pointer_chain::Status::ok});
+  if (key.parent != no_parent) {
+    if (scratch.levels.size() <= depth) {
+      scratch.levels.resize(depth + 1);
+    }
+    scratch.levels[depth].push_back(it->second);
+  }
+
+  return it->second;
+}
+
+template <class T>
+T load(const uint8_t *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+uint64_t load_pointer(const uint8_t *data, uint8_t size) {
+  return size == 8 ? load<uint64_t>(data) : load<uint32_t>(data);
+}
+
+double to_number(pointer_chain::ValueType type, uint64_t raw) {
+  const auto data = reinterpret_cast<const uint8_t *>(&raw);
+
+  switch (type) {
+    case pointer_chain::ValueType::i8:
+      return load<int8_t>(data);
+    case pointer_chain::ValueType::i16:
+      return load<int16_t>(data);
+    case pointer_chain::ValueType::i32:
+      return load<int32_t>(data);
+    case pointer_chain::ValueType::u32:
+      return load<uint32_t>(data);
+    case pointer_chain::ValueType::f32:
+      return load<float>(data);
+    case pointer_chain::ValueType::i64:
+      return static_cast<double>(load<int64_t>(data));
+    case pointer_chain::ValueType::f64:
+      return load<double>(data);
+    case pointer_chain::ValueType::pointer:
+      return static_cast<double>(raw);
+  }
+
+  return 0;
+}
+
+pointer_chain::Status failure_status(memory::ReadStatus status) {
+  switch (status) {
+    case memory::ReadStatus::zero_pointer:
+      return pointer_chain::Status::null_pointer;
+    case memory::ReadStatus::unmapped:
+      return pointer_chain::Status::unmapped;
+    case memory::ReadStatus::partial:
+      return pointer_chain::Status::partial;
+    default:
+      return pointer_chain::Status::read_failed;
+  }
+}
+
+// Fetches every node of one depth whose parent resolved, with a single batched read.
+void resolve_level(void *process, Scratch &scratch, const std::vector<uint32_t> &level) {
+  scratch.requests.clear();
+  scratch.requested.clear();
+
+  std::size_t data_size = 0;
+  for (const auto id : level) {
+    auto &node = scratch.nodes[id];
+    const auto &parent = scratch.nodes[node.parent];
+    if (parent.status != pointer_chain::Status::ok) {
+      node.status = parent.status;
+      continue;
+    }
+
+    scratch.requests.push_back(ReadRequest{static_cast<uintptr_t>(parent.value + node.offset), node.size});
+    scratch.requested.push_back(id);
+    data_size += node.size;
+  }
+
+  if (scratch.requests.empty()) {
+    return;
+  }
+
+  scratch.buffer.resize(data_size);
+  scratch.success.assign((scratch.requests.size() + 7) / 8, 0);
+  memory::read_batch(process, scratch.requests, scratch.buffer.data(), scratch.success.data());
+
+  const uint8_t *data = scratch.buffer.data();
+  for (std::size_t i = 0; i < scratch.requested.size(); ++i) {
+    auto &node = scratch.nodes[scratch.requested[i]];
+    const auto read = (scratch.success[i / 8] >> (i % 8)) & 1;
+
+    if (!read) {
+      const auto &request = scratch.requests[i];
+      node.status = failure_status(memory::unreadable_status(process, request.address, request.size));
+    } else if (node.kind == link_kind) {
+      node.value = load_pointer(data, node.size);
+      node.status = node.value == 0 ? pointer_chain::Status::null_pointer : pointer_chain::Status::ok;
+    } else {
+      node.value = 0;
+      std::memcpy(&node.value, data, node.size);
+    }
+
+    data += node.size;
+  }
+}
+
+}  // namespace
+
+pointer_chain::Program pointer_chain::compile(uintptr_t base, std::vector<int64_t> offsets, ValueType type, int bitness) {
+  if (offsets.empty()) {
+    offsets.push_back(0);
+  }
+
+  return Program{base, std::move(offsets), type, static_cast<uint8_t>(bitness == 64 ? 8 : 4)};
+}
+
+std::size_t pointer_chain::value_size(const Program &program) {
+  switch (program.type) {
+    case ValueType::i8:
+      return 1;
+    case ValueType::i16:
+      return 2;
+    case ValueType::i32:
+    case ValueType::u32:
+    case ValueType::f32:
+      return 4;
+    case ValueType::i64:
+    case ValueType::f64:
+      return 8;
+    case ValueType::pointer:
+      return program.pointer_size;
+  }
+
+  return 0;
+}
+
+std::size_t pointer_chain::evaluate(void *process, std::span<const Program *const> programs, std::span<Result> results) {
+  thread_local Scratch scratch;
+  scratch.clear();
+
+  // Build a trie of every chain, roots are keyed by base and pointer size so 32 and 64-bit programs never share links
+  for (const auto program : programs) {
+    auto node = intern(scratch, NodeKey{no_parent, program->pointer_size, link_kind, static_cast<int64_t>(program->base)}, 0);
+    scratch.nodes[node].value = program->base;
+    if (program->base == 0) {
+      scratch.nodes[node].status = Status::null_pointer;
+    }
+
+    const auto last = program->offsets.size() - 1;
+    for (std::size_t depth = 0; depth < last; ++depth) {
+      node = intern(scratch, NodeKey{node, program->pointer_size, link_kind, program->offsets[depth]}, depth);
+    }
+
+    const auto is_pointer = program->type == ValueType::pointer;
+    const auto key = NodeKey{
+      node,
+      static_cast<uint8_t>(value_size(*program)),
+      is_pointer ? link_kind : static_cast<uint8_t>(program->type),
+      program->offsets[last],
+    };
+    scratch.leaves.push_back(intern(scratch, key, last));
+  }
+
+  for (const auto &level : scratch.levels) {
+    resolve_level(process, scratch, level);
+  }
+
+  std::size_t resolved = 0;
+  for (std::size_t i = 0; i < programs.size() && i < results.size(); ++i) {
+    const auto &leaf = scratch.nodes[scratch.leaves[i]];
+    results[i] = Result{leaf.status == Status::ok ? to_number(programs[i]->type, leaf.value) : 0, leaf.status};
+    resolved += leaf.status == Status::ok;
+  }
+
+  return resolved;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace pointer_chain {
+
+enum class ValueType : uint8_t { i8, i16, i32, u32, f32, i64, f64, pointer };
+
+enum class Status : uint8_t {
+  ok = 0,
+  // The base or one of the dereferenced pointers (or a pointer typed result) was zero
+  null_pointer = 1,
+  // Reading one of the links or the final value failed for a reason not covered below
+  read_failed = 2,
+  // A link pointed to memory that is not mapped readable
+  unmapped = 3,
+  // A read started in readable memory but ran past its end
+  partial = 4,
+};
+
+// Compiled form of `[[[base + offsets[0]] + offsets[1]] ... + offsets[n - 1]]`: every offset but the last one is added
+// and dereferenced as a pointer of the program's bitness, the last one is added and read as `type`.
+struct Program {
+  uintptr_t base;
+  std::vector<int64_t> offsets;
+  ValueType type;
+  uint8_t pointer_size;
+};
+
+Program compile(uintptr_t base, std::vector<int64_t> offsets, ValueType type, int bitness);
+
+std::size_t value_size(const Program &program);
+
+struct Result {
+  double value;
+  Status status;
+};
+
+// Evaluates all programs against the process. Links shared by several programs (same base, same leading offsets and
+// same bitness) are dereferenced once, and every depth of the chains is fetched with a single memory::read_batch.
+// Returns the number of programs that resolved with Status::ok.
+std::size_t evaluate(void *process, std::span<const Program *const> programs, std::span<Result> results);
+
+}  // namespace pointer_chain
@@ -0,0 +1,232 @@
+#include "process_watcher.h"
+
+#include <algorithm>
+#include "memory.h"
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+process_watcher::ProcessInfo describe(uint32_t pid) {
+  auto info = process_watcher::ProcessInfo{pid, "", "", "", memory::is_process_64bit(pid), 0};
+
+  const auto handle = memory::open_process(pid);
+  if (handle == nullptr) {
+    return info;
+  }
+
+  info.path = memory::get_process_path(handle);
+  info.command_line = memory::get_process_command_line(handle);
+  info.cwd = memory::get_process_cwd(handle);
+  info.start_time = memory::get_process_start_time(handle);
+  memory::close_handle(handle);
+
+  return info;
+}
+
+uint64_t start_time(uint32_t pid) {
+  const auto handle = memory::open_process(pid);
+  if (handle == nullptr) {
+    return 0;
+  }
+
+  const auto time = memory::get_process_start_time(handle);
+  memory::close_handle(handle);
+  return time;
+}
+
+// Descriptor that becomes readable once the process exits, -1 where that is not available.
+int open_exit_fd(uint32_t pid) {
+#if defined(__linux__) && defined(SYS_pidfd_open)
+  return static_cast<int>(syscall(SYS_pidfd_open, static_cast<pid_t>(pid), 0));
+#else
+  return -1;
+#endif
+}
+
+}  // namespace
+
+process_watcher::Watcher::Watcher(std::vector<std::string> names, std::chrono::milliseconds interval, Callback callback)
+    : names_(std::move(names)), interval_(interval), callback_(std::move(callback)) {
+#ifdef __linux__
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (epoll_fd_ != -1 && stop_fd_ != -1) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = UINT64_MAX;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, stop_fd_, &event);
+  }
+#endif
+}
+
+process_watcher::Watcher::~Watcher() {
+  stop();
+
+#ifdef __linux__
+  for (const auto &[pid, process] : tracked_) {
+    if (process.exit_fd != -1) {
+      close(process.exit_fd);
+    }
+  }
+  if (stop_fd_ != -1) {
+    close(stop_fd_);
+  }
+  if (epoll_fd_ != -1) {
+    close(epoll_fd_);
+  }
+#endif
+}
+
+void process_watcher::Watcher::start() {
+  std::lock_guard lock(mutex_);
+  if (thread_.joinable()) {
+    return;
+  }
+
+  stopping_ = false;
+  thread_ = std::thread(&Watcher::run, this);
+}
+
+void process_watcher::Watcher::stop() {
+  {
+    std::lock_guard lock(mutex_);
+    if (!thread_.joinable()) {
+      return;
+    }
+
+    stopping_ = true;
+  }
+
+  wake_.notify_all();
+#ifdef __linux__
+  if (stop_fd_ != -1) {
+    const uint64_t value = 1;
+    [[maybe_unused]] const auto written = write(stop_fd_, &value, sizeof(value));
+  }
+#endif
+  thread_.join();
+}
+
+void process_watcher::Watcher::run() {
+  auto events = std::vector<Event>();
+  auto exited = std::vector<uint32_t>();
+  auto next_walk = std::chrono::steady_clock::now();
+
+  while (true) {
+    events.clear();
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= next_walk) {
+      walk(events);
+      next_walk = now + interval_;
+    }
+
+    for (const auto pid : exited) {
+      detach(pid, events);
+    }
+
+    if (!events.empty()) {
+      callback_(std::move(events));
+      events = std::vector<Event>();
+    }
+
+    const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(next_walk - std::chrono::steady_clock::now());
+    if (!wait(std::max(timeout, std::chrono::milliseconds(0)), exited)) {
+      return;
+    }
+  }
+}
+
+void process_watcher::Watcher::walk(std::vector<Event> &events) {
+  auto pids = memory::find_processes(names_);
+  std::sort(pids.begin(), pids.end());
+  pids.erase(std::unique(pids.begin(), pids.end()), pids.end());
+
+  // Exits are normally reported through the pidfd already, this catches the rest
+  auto gone = std::vector<uint32_t>();
+  for (const auto &[pid, process] : tracked_) {
+    if (!std::binary_search(pids.begin(), pids.end(), pid)) {
+      gone.push_back(pid);
+    }
+  }
+  for (const auto pid : gone) {
+    detach(pid, events);
+  }
+
+  std::erase_if(exited_, [&pids](const auto &item) { return !std::binary_search(pids.begin(), pids.end(), item.first); });
+
+  for (const auto pid : pids) {
+    if (tracked_.contains(pid)) {
+      continue;
+    }
+
+    const auto exited = exited_.find(pid);
+    if (exited != exited_.end()) {
+      if (exited->second == start_time(pid)) {
+        continue;
+      }
+      exited_.erase(exited);
+    }
+
+    auto tracked = Tracked{describe(pid), open_exit_fd(pid)};
+#ifdef __linux__
+    if (tracked.exit_fd != -1) {
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.u64 = pid;
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, tracked.exit_fd, &event);
+    }
+#endif
+
+    events.push_back(Event{true, tracked.info});
+    tracked_.emplace(pid, std::move(tracked));
+  }
+}
+
+void process_watcher::Watcher::detach(uint32_t pid, std::vector<Event> &events) {
+  const auto process = tracked_.find(pid);
+  if (process == tracked_.end()) {
+    return;
+  }
+
+#ifdef __linux__
+  if (process->second.exit_fd != -1) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, process->second.exit_fd, nullptr);
+    close(process->second.exit_fd);
+  }
+#endif
+
+  exited_[pid] = process->second.info.start_time;
+  events.push_back(Event{false, std::move(process->second.info)});
+  tracked_.erase(process);
+}
+
+// Sleeps until the timeout passes, a tracked process exits or the watcher stops. Returns false once it should stop.
+bool process_watcher::Watcher::wait(std::chrono::milliseconds timeout, std::vector<uint32_t> &exited) {
+  exited.clear();
+
+#ifdef __linux__
+  if (epoll_fd_ != -1 && stop_fd_ != -1) {
+    epoll_event ready[16];
+    const auto count = epoll_wait(epoll_fd_, ready, 16, static_cast<int>(timeout.count()));
+    for (int i = 0; i < count; ++i) {
+      if (ready[i].data.u64 == UINT64_MAX) {
+        return false;
+      }
+      exited.push_back(static_cast<uint32_t>(ready[i].data.u64));
+    }
+
+    std::lock_guard lock(mutex_);
+    return !stopping_;
+  }
+#endif
+
+  std::unique_lock lock(mutex_);
+  return !wake_.wait_for(lock, timeout, [this] { return stopping_; });
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace process_watcher {
+
+// Gathered once when a process shows up, none of it changes while the process runs.
+struct ProcessInfo {
+  uint32_t pid;
+  std::string path;
+  std::string command_line;
+  std::string cwd;
+  bool is_64bit;
+  uint64_t start_time;
+};
+
+struct Event {
+  // True when the process appeared, false when it exited
+  bool attached;
+  ProcessInfo process;
+};
+
+using Callback = std::function<void(std::vector<Event> events)>;
+
+// Reports processes matching `names` (same matching as memory::find_processes) as they start and exit. New processes
+// are found by a process list walk every `interval`. On Linux every reported process is also held through a pidfd in
+// an epoll set, so its exit is reported right away instead of on the next walk.
+class Watcher {
+ public:
+  Watcher(std::vector<std::string> names, std::chrono::milliseconds interval, Callback callback);
+  ~Watcher();
+
+  Watcher(const Watcher &) = delete;
+  Watcher &operator=(const Watcher &) = delete;
+
+  void start();
+  // Joins the watcher thread, the callback is not called after it returns.
+  void stop();
+
+ private:
+  struct Tracked {
+    ProcessInfo info;
+    // pidfd of the process, -1 if exits are only noticed by the list walk
+    int exit_fd;
+  };
+
+  void run();
+  void walk(std::vector<Event> &events);
+  void detach(uint32_t pid, std::vector<Event> &events);
+  bool wait(std::chrono::milliseconds timeout, std::vector<uint32_t> &exited);
+
+  std::vector<std::string> names_;
+  std::chrono::milliseconds interval_;
+  Callback callback_;
+
+  std::map<uint32_t, Tracked> tracked_;
+  // Start time of processes reported as exited that are still listed, an unreaped zombie keeps its /proc entry
+  std::map<uint32_t, uint64_t> exited_;
+  // epoll set of the pidfds plus the stop eventfd (Linux only)
+  int epoll_fd_ = -1;
+  int stop_fd_ = -1;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace process_watcher
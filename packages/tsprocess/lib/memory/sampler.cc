@@ -0,0 +1,211 @@
+#include "sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "memory.h"
+
+sampler::Ring::Ring(std::size_t capacity, std::size_t width)
+    : slots_(std::max<std::size_t>(capacity, 1) * width), capacity_(std::max<std::size_t>(capacity, 1)), width_(width) {}
+
+bool sampler::Ring::push(const double *record) {
+  const auto head = head_.load(std::memory_order_relaxed);
+  if (head - tail_.load(std::memory_order_acquire) == capacity_) {
+    return false;
+  }
+
+  std::copy(record, record + width_, slots_.begin() + (head % capacity_) * width_);
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+std::size_t sampler::Ring::drain(std::vector<double> &out) {
+  const auto tail = tail_.load(std::memory_order_relaxed);
+  const auto head = head_.load(std::memory_order_acquire);
+
+  for (auto position = tail; position != head; ++position) {
+    const auto slot = slots_.begin() + (position % capacity_) * width_;
+    out.insert(out.end(), slot, slot + width_);
+  }
+
+  tail_.store(head, std::memory_order_release);
+  return head - tail;
+}
+
+sampler::Sampler::Sampler(void *process, std::chrono::microseconds interval) : process_(process), interval_(interval) {}
+
+sampler::Sampler::~Sampler() {
+  stop();
+}
+
+std::shared_ptr<sampler::Channel> sampler::Sampler::add_tail(Tail tail, std::size_t capacity) {
+  auto channel = std::make_shared<Channel>(capacity, 2);
+  channel->is_tail = true;
+  channel->tail = std::move(tail);
+
+  std::lock_guard lock(mutex_);
+  channels_.push_back(channel);
+  return channel;
+}
+
+std::shared_ptr<sampler::Channel>
+sampler::Sampler::add_snapshot(std::vector<pointer_chain::Program> programs, std::size_t capacity) {
+  auto channel = std::make_shared<Channel>(capacity, programs.size());
+  channel->programs = std::move(programs);
+
+  std::lock_guard lock(mutex_);
+  channels_.push_back(channel);
+  return channel;
+}
+
+void sampler::Sampler::remove(const Channel *channel) {
+  std::lock_guard lock(mutex_);
+  std::erase_if(channels_, [channel](const auto &entry) { return entry.get() == channel; });
+}
+
+void sampler::Sampler::set_interval(std::chrono::microseconds interval) {
+  {
+    std::lock_guard lock(state_mutex_);
+    interval_ = interval;
+  }
+
+  wake_.notify_all();
+}
+
+void sampler::Sampler::start() {
+  std::lock_guard lock(state_mutex_);
+  if (thread_.joinable()) {
+    return;
+  }
+
+  stopping_ = false;
+  thread_ = std::thread(&Sampler::run, this);
+}
+
+void sampler::Sampler::stop() {
+  {
+    std::lock_guard lock(state_mutex_);
+    if (!thread_.joinable()) {
+      return;
+    }
+
+    stopping_ = true;
+  }
+
+  wake_.notify_all();
+  thread_.join();
+}
+
+void sampler::Sampler::run() {
+  auto next = std::chrono::steady_clock::now();
+
+  std::unique_lock lock(state_mutex_);
+  while (!stopping_) {
+    lock.unlock();
+    sample();
+    lock.lock();
+
+    next = std::max(next + interval_, std::chrono::steady_clock::now());
+    wake_.wait_until(lock, next, [this] { return stopping_; });
+  }
+}
+
+void sampler::Sampler::sample() {
+  std::lock_guard lock(mutex_);
+
+  // Chains of every channel resolve together, tails and snapshots below the same root share its links
+  programs_.clear();
+  for (const auto &channel : channels_) {
+    if (channel->is_tail) {
+      programs_.push_back(&channel->tail.items);
+      programs_.push_back(&channel->tail.size);
+    } else {
+      for (const auto &program : channel->programs) {
+        programs_.push_back(&program);
+      }
+    }
+  }
+
+  results_.resize(programs_.size());
+  if (!programs_.empty()) {
+    pointer_chain::evaluate(process_, programs_, results_);
+  }
+
+  std::size_t index = 0;
+  for (const auto &channel : channels_) {
+    if (channel->is_tail) {
+      sample_tail(*channel, results_[index], results_[index + 1]);
+      index += 2;
+    } else {
+      sample_snapshot(*channel, std::span(results_).subspan(index, channel->programs.size()));
+      index += channel->programs.size();
+    }
+  }
+}
+
+void sampler::Sampler::sample_tail(Channel &channel, const pointer_chain::Result &items, const pointer_chain::Result &size) {
+  if (items.status != pointer_chain::Status::ok || size.status != pointer_chain::Status::ok || size.value < 0) {
+    return;
+  }
+
+  const auto array = static_cast<uintptr_t>(items.value);
+  const auto length = static_cast<std::size_t>(size.value);
+  if (array != channel.items || length < channel.next) {
+    channel.items = array;
+    channel.next = 0;
+  }
+
+  const auto count = std::min(length - channel.next, max_tail_read);
+  if (count == 0) {
+    return;
+  }
+
+  const auto &tail = channel.tail;
+  const auto element_size = struct_layout::type_size(tail.element, tail.items.pointer_size);
+
+  buffer_.resize(count * element_size);
+  const auto address = array + tail.header + channel.next * element_size;
+  if (!memory::read_buffer(process_, address, buffer_.size(), buffer_.data())) {
+    return;
+  }
+
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto value = struct_layout::decode_value(tail.element, buffer_.data() + i * element_size, tail.items.pointer_size);
+    if (value < tail.min || value > tail.max) {
+      break;
+    }
+
+    const double record[] = {static_cast<double>(channel.next), value};
+    if (!channel.ring.push(record)) {
+      break;
+    }
+
+    ++channel.next;
+  }
+}
+
+void sampler::Sampler::sample_snapshot(Channel &channel, std::span<const pointer_chain::Result> results) {
+  thread_local std::vector<double> row;
+
+  row.resize(results.size());
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    row[i] = results[i].status == pointer_chain::Status::ok ? results[i].value : std::nan("");
+  }
+
+  if (channel.sampled && std::memcmp(row.data(), channel.row.data(), row.size() * sizeof(double)) == 0) {
+    return;
+  }
+
+  // A full ring keeps the row pending so the latest state goes out once there is room, it is counted only once
+  if (!channel.ring.push(row.data())) {
+    if (channel.rejected.size() != row.size() ||
+        std::memcmp(row.data(), channel.rejected.data(), row.size() * sizeof(double)) != 0) {
+      channel.rejected = row;
+      channel.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    return;
+  }
+
+  channel.sampled = true;
+  channel.row = row;
+}
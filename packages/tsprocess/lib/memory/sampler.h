@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "pointer_chain.h"
+#include "struct_layout.h"
+
+namespace sampler {
+
+// Most elements a tail reads in one sample, longer backlogs are caught up over the following samples
+constexpr std::size_t max_tail_read = 0x1000;
+
+// Lock-free ring of fixed width records between the sampling thread (the only producer) and the JS thread (the only
+// consumer). Positions only ever grow, the slot of a record is its position modulo the capacity.
+class Ring {
+ public:
+  Ring(std::size_t capacity, std::size_t width);
+
+  // Producer side, returns false without writing if the ring is full.
+  bool push(const double *record);
+
+  // Consumer side, appends every available record to `out` and returns how many there were.
+  std::size_t drain(std::vector<double> &out);
+
+  std::size_t width() const {
+    return width_;
+  }
+
+ private:
+  std::vector<double> slots_;
+  std::size_t capacity_;
+  std::size_t width_;
+  alignas(64) std::atomic<std::size_t> head_{0};
+  alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+// Follows an append-only array: [items] is the array object and [size] its used length, every new element is
+// published as an (index, value) record. A different array object or a shorter length restarts at index 0.
+struct Tail {
+  pointer_chain::Program items;
+  pointer_chain::Program size;
+  // Bytes in front of the first element
+  uint32_t header;
+  struct_layout::FieldType element;
+  // An element outside [min, max] is taken as not written yet, the tail stops in front of it until the next sample
+  double min;
+  double max;
+};
+
+struct Channel {
+  Channel(std::size_t capacity, std::size_t width) : ring(capacity, width) {}
+
+  Ring ring;
+  // Snapshot rows that did not fit in the ring, tails never drop and wait for the consumer instead
+  std::atomic<uint64_t> dropped{0};
+
+  // Source, either a tail or the chains of a snapshot
+  bool is_tail = false;
+  Tail tail;
+  std::vector<pointer_chain::Program> programs;
+
+  // Sampling thread state
+  uintptr_t items = 0;
+  std::size_t next = 0;
+  bool sampled = false;
+  std::vector<double> row;
+  std::vector<double> rejected;
+};
+
+// Samples tails and snapshots on its own thread at a fixed rate, independent of how often JS looks at the results.
+// Snapshot rows hold one value per chain (NaN for chains that did not resolve) and are only published when they differ
+// from the previous row, so short lived states between two JS ticks are kept.
+class Sampler {
+ public:
+  Sampler(void *process, std::chrono::microseconds interval);
+  ~Sampler();
+
+  Sampler(const Sampler &) = delete;
+  Sampler &operator=(const Sampler &) = delete;
+
+  std::shared_ptr<Channel> add_tail(Tail tail, std::size_t capacity);
+  std::shared_ptr<Channel> add_snapshot(std::vector<pointer_chain::Program> programs, std::size_t capacity);
+  void remove(const Channel *channel);
+
+  void set_interval(std::chrono::microseconds interval);
+
+  void start();
+  void stop();
+
+  // Takes one sample of every channel.
+  void sample();
+
+ private:
+  void run();
+  void sample_tail(Channel &channel, const pointer_chain::Result &items, const pointer_chain::Result &size);
+  void sample_snapshot(Channel &channel, std::span<const pointer_chain::Result> results);
+
+  void *process_;
+
+  // Guards the channel list, the rings themselves are lock-free
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<Channel>> channels_;
+  std::vector<const pointer_chain::Program *> programs_;
+  std::vector<pointer_chain::Result> results_;
+  std::vector<uint8_t> buffer_;
+
+  std::mutex state_mutex_;
+  std::condition_variable wake_;
+  std::chrono::microseconds interval_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace sampler
@@ -0,0 +1,362 @@
+#include "scan_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint32_t cache_magic = 0x43535354;  // TSSC
+constexpr uint32_t cache_version = 1;
+
+// Binaries remembered per cache file, the least recently used one is dropped first
+constexpr std::size_t max_images = 8;
+constexpr std::size_t max_entries = 4096;
+// Leading bytes of the executable that go into the build hash
+constexpr std::size_t header_hash_size = 0x10000;
+// Regions of the cached size tried when the exact address no longer matches
+constexpr std::size_t max_relocation_candidates = 64;
+
+struct CacheEntry {
+  uint64_t pattern_hash;
+  uint64_t address;
+  uint64_t region_offset;
+  uint64_t region_size;
+};
+
+struct CacheImage {
+  uint64_t key;
+  std::vector<CacheEntry> entries;
+};
+
+uint64_t fnv1a(const void *data, std::size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+  const auto bytes = static_cast<const uint8_t *>(data);
+  for (std::size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+template <class T>
+uint64_t fnv1a_value(const T &value, uint64_t hash) {
+  return fnv1a(&value, sizeof(T), hash);
+}
+
+std::filesystem::path to_path(const std::string &utf8) {
+  return std::filesystem::path(std::u8string(utf8.begin(), utf8.end()));
+}
+
+// Identifies the running binary by path, size, modification time and a hash of its first bytes. Returns 0 if the
+// executable cannot be inspected.
+uint64_t image_key(void *process) {
+  const auto exe_path = memory::get_process_path(process);
+  if (exe_path.empty()) {
+    return 0;
+  }
+
+  const auto path = to_path(exe_path);
+
+  std::error_code error;
+  const auto size = std::filesystem::file_size(path, error);
+  if (error) {
+    return 0;
+  }
+
+  const auto modified = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+  if (error) {
+    return 0;
+  }
+
+  std::ifstream file(path, std::ios::binary);
+  if (!file.good()) {
+    return 0;
+  }
+
+  auto header = std::vector<char>(std::min<std::size_t>(size, header_hash_size));
+  file.read(header.data(), static_cast<std::streamsize>(header.size()));
+  header.resize(static_cast<std::size_t>(file.gcount()));
+
+  auto hash = fnv1a(exe_path.data(), exe_path.size());
+  hash = fnv1a_value(static_cast<uint64_t>(size), hash);
+  hash = fnv1a_value(static_cast<int64_t>(modified), hash);
+  hash = fnv1a(header.data(), header.size(), hash);
+
+  return hash == 0 ? 1 : hash;
+}
+
+uint64_t pattern_hash(const Pattern &pattern) {
+  auto hash = fnv1a_value(static_cast<uint64_t>(pattern.signature.size()), 0xcbf29ce484222325ULL);
+  hash = fnv1a(pattern.signature.data(), pattern.signature.size(), hash);
+  hash = fnv1a(pattern.mask.data(), pattern.mask.size(), hash);
+  return fnv1a_value(static_cast<uint8_t>(pattern.non_zero_mask), hash);
+}
+
+template <class T>
+bool read_value(std::ifstream &file, T &value) {
+  file.read(reinterpret_cast<char *>(&value), sizeof(T));
+  return file.good();
+}
+
+template <class T>
+void write_value(std::ofstream &file, const T &value) {
+  file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+std::vector<CacheImage> load(const std::filesystem::path &path) {
+  auto images = std::vector<CacheImage>();
+
+  std::ifstream file(path, std::ios::binary);
+  if (!file.good()) {
+    return images;
+  }
+
+  uint32_t magic = 0, version = 0, image_count = 0;
+  if (!read_value(file, magic) || !read_value(file, version) || !read_value(file, image_count)) {
+    return images;
+  }
+
+  if (magic != cache_magic || version != cache_version || image_count > max_images) {
+    return images;
+  }
+
+  for (uint32_t i = 0; i < image_count; ++i) {
+    CacheImage image;
+    uint32_t entry_count = 0;
+    if (!read_value(file, image.key) || !read_value(file, entry_count) || entry_count > max_entries) {
+      return {};
+    }
+
+    image.entries.resize(entry_count);
+    file.read(reinterpret_cast<char *>(image.entries.data()), entry_count * sizeof(CacheEntry));
+    if (!file.good()) {
+      return {};
+    }
+
+    images.push_back(std::move(image));
+  }
+
+  return images;
+}
+
+// Unique per process and per save, so concurrent saves never write into the same file before it is renamed in place
+std::filesystem::path temporary_path_for(const std::filesystem::path &path) {
+  static std::atomic<uint32_t> counter = 0;
+#ifdef _WIN32
+  const auto pid = _getpid();
+#else
+  const auto pid = getpid();
+#endif
+
+  auto temporary_path = path;
+  temporary_path += "." + std::to_string(pid) + "." + std::to_string(counter.fetch_add(1)) + ".tmp";
+  return temporary_path;
+}
+
+void save(const std::filesystem::path &path, const std::vector<CacheImage> &images) {
+  std::error_code error;
+  std::filesystem::create_directories(path.parent_path(), error);
+
+  const auto temporary_path = temporary_path_for(path);
+
+  {
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!file.good()) {
+      return;
+    }
+
+    write_value(file, cache_magic);
+    write_value(file, cache_version);
+    write_value(file, static_cast<uint32_t>(images.size()));
+
+    for (const auto &image : images) {
+      write_value(file, image.key);
+      write_value(file, static_cast<uint32_t>(image.entries.size()));
+      file.write(reinterpret_cast<const char *>(image.entries.data()), image.entries.size() * sizeof(CacheEntry));
+    }
+
+    if (!file.good()) {
+      file.close();
+      std::filesystem::remove(temporary_path, error);
+      return;
+    }
+  }
+
+  std::filesystem::rename(temporary_path, path, error);
+  if (error) {
+    std::filesystem::remove(temporary_path, error);
+  }
+}
+
+const MemoryRegion *find_region(const std::vector<MemoryRegion> &regions, uintptr_t address) {
+  const auto it = std::upper_bound(regions.begin(), regions.end(), address, [](uintptr_t value, const MemoryRegion &region) {
+    return value < region.address;
+  });
+
+  if (it == regions.begin()) {
+    return nullptr;
+  }
+
+  const auto &region = *std::prev(it);
+  return address - region.address < region.size ? &region : nullptr;
+}
+
+// Returns the address the cached entry still matches at, or 0.
+uintptr_t validate(
+  void *process,
+  const scanner::CompiledPattern &pattern,
+  const CacheEntry &entry,
+  const std::vector<MemoryRegion> &regions
+) {
+  auto buffer = std::vector<uint8_t>(pattern.size());
+  const auto matches = [&](uintptr_t address) {
+    return memory::read_buffer(process, address, buffer.size(), buffer.data()) && pattern.matches_at(buffer.data());
+  };
+
+  if (pattern.empty() || pattern.impossible()) {
+    return 0;
+  }
+
+  const auto cached = static_cast<uintptr_t>(entry.address);
+  if (find_region(regions, cached) != nullptr && matches(cached)) {
+    return cached;
+  }
+
+  std::size_t candidates = 0;
+  for (const auto &region : regions) {
+    if (region.size != entry.region_size || entry.region_offset + pattern.size() > region.size) {
+      continue;
+    }
+
+    const auto address = region.address + static_cast<uintptr_t>(entry.region_offset);
+    if (address != entry.address && matches(address)) {
+      return address;
+    }
+
+    if (++candidates >= max_relocation_candidates) {
+      break;
+    }
+  }
+
+  return 0;
+}
+
+}  // namespace
+
+std::vector<PatternResult> scan_cache::batch_find_pattern(
+  void *process,
+  std::vector<Pattern> patterns,
+  const std::string &path,
+  const std::atomic<bool> *cancel,
+  const RegionFilter &filter
+) {
+  const auto key = image_key(process);
+  if (key == 0 || path.empty()) {
+    return memory::batch_find_pattern(process, std::move(patterns), cancel, filter);
+  }
+
+  const auto cache_path = to_path(path);
+  auto images = load(cache_path);
+
+  auto cached = std::unordered_map<uint64_t, CacheEntry>();
+  const auto image = std::find_if(images.begin(), images.end(), [key](const CacheImage &item) {
+    return item.key == key;
+  });
+  if (image != images.end()) {
+    for (const auto &entry : image->entries) {
+      cached.emplace(entry.pattern_hash, entry);
+    }
+  }
+
+  const auto table = memory::query_regions(process);
+  const auto regions = memory::filter_regions(*table, filter);
+
+  auto results = std::vector<PatternResult>();
+  auto remaining = std::vector<Pattern>();
+  auto hashes = std::unordered_map<int, uint64_t>();
+  auto changed = image == images.end();
+
+  for (const auto &pattern : patterns) {
+    if (pattern.found || pattern.all) {
+      remaining.push_back(pattern);
+      continue;
+    }
+
+    const auto hash = pattern_hash(pattern);
+    hashes.emplace(pattern.index, hash);
+
+    const auto entry = cached.find(hash);
+    if (entry != cached.end()) {
+      const auto compiled = scanner::CompiledPattern(pattern.signature, pattern.mask, pattern.non_zero_mask);
+      const auto address = validate(process, compiled, entry->second, regions);
+      if (address != 0) {
+        changed = changed || address != entry->second.address;
+        results.push_back(PatternResult{pattern.index, address});
+        continue;
+      }
+    }
+
+    remaining.push_back(pattern);
+  }
+
+  if (!remaining.empty()) {
+    changed = true;
+    const auto scanned = memory::batch_find_pattern(process, std::move(remaining), cancel, filter);
+    results.insert(results.end(), scanned.begin(), scanned.end());
+  }
+
+  // Missing patterns of an interrupted scan must not drop their cache entries
+  if (cancel != nullptr && cancel->load()) {
+    return results;
+  }
+
+  if (!changed) {
+    return results;
+  }
+
+  auto refreshed = CacheImage{key, {}};
+  for (const auto &result : results) {
+    const auto hash = hashes.find(result.index);
+    if (hash == hashes.end()) {
+      continue;
+    }
+
+    const auto region = find_region(regions, result.address);
+    refreshed.entries.push_back(CacheEntry{
+      hash->second,
+      result.address,
+      region ? result.address - region->address : 0,
+      region ? region->size : 0,
+    });
+  }
+
+  // Keep entries of patterns that were not part of this batch
+  for (const auto &[hash, entry] : cached) {
+    const auto in_batch = std::any_of(hashes.begin(), hashes.end(), [hash](const auto &item) {
+      return item.second == hash;
+    });
+    if (!in_batch && refreshed.entries.size() < max_entries) {
+      refreshed.entries.push_back(entry);
+    }
+  }
+
+  if (image != images.end()) {
+    images.erase(image);
+  }
+  images.insert(images.begin(), std::move(refreshed));
+  if (images.size() > max_images) {
+    images.resize(max_images);
+  }
+
+  save(cache_path, images);
+
+  return results;
+}
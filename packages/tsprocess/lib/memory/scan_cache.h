@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "memory.h"
+
+namespace scan_cache {
+
+// Same as memory::batch_find_pattern, but first tries the addresses remembered in the cache file at `path` for the
+// running binary. A cached address is only used after the signature bytes at it were read back and matched, either at
+// the exact address or at the same offset in a region of the same size (for relocated heaps). Patterns without a
+// valid entry go through a regular scan, and the refreshed entries are written back to the file.
+//
+// Patterns with `all` set are never cached. A validated address is not guaranteed to be the lowest match, which is
+// fine for signatures meant to be unique. A cancelled scan leaves the cache file untouched. Cached addresses outside the
+// regions selected by `filter` are ignored.
+std::vector<PatternResult> batch_find_pattern(
+  void *process,
+  std::vector<Pattern> patterns,
+  const std::string &path,
+  const std::atomic<bool> *cancel = nullptr,
+  const RegionFilter &filter = {}
+);
+
+}  // namespace scan_cache
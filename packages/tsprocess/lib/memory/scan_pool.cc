@@ -0,0 +1,178 @@
+#include "scan_pool.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Number of threads scanning in parallel including the caller, 0 uses the hardware concurrency
+#ifndef TSPROCESS_SCAN_THREADS
+#define TSPROCESS_SCAN_THREADS 0
+#endif
+
+namespace {
+
+struct WorkQueue {
+  std::mutex mutex;
+  std::deque<std::size_t> items;
+};
+
+struct Job {
+  const scan_pool::Task *task;
+  const std::atomic<bool> *cancel;
+  std::vector<WorkQueue> queues;
+  std::atomic<std::size_t> next_slot{0};
+  std::atomic<std::size_t> remaining{0};
+  std::mutex done_mutex;
+  std::condition_variable done;
+
+  Job(const scan_pool::Task *task, const std::atomic<bool> *cancel, std::size_t queue_count)
+      : task(task), cancel(cancel), queues(queue_count) {}
+
+  std::optional<std::size_t> take(std::size_t home) {
+    {
+      auto &queue = queues[home];
+      std::lock_guard lock(queue.mutex);
+      if (!queue.items.empty()) {
+        const auto item = queue.items.front();
+        queue.items.pop_front();
+        return item;
+      }
+    }
+
+    for (std::size_t i = 1; i < queues.size(); ++i) {
+      auto &victim = queues[(home + i) % queues.size()];
+      std::lock_guard lock(victim.mutex);
+      if (!victim.items.empty()) {
+        const auto item = victim.items.back();
+        victim.items.pop_back();
+        return item;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  // Drains the queues from the given slot until no work is left anywhere.
+  void work(std::size_t slot) {
+    const auto home = slot % queues.size();
+
+    while (const auto item = take(home)) {
+      if (cancel == nullptr || !cancel->load(std::memory_order_relaxed)) {
+        (*task)(*item, slot);
+      }
+
+      if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard lock(done_mutex);
+        done.notify_all();
+      }
+    }
+  }
+};
+
+class Pool {
+ public:
+  Pool() {
+    const auto thread_count = TSPROCESS_SCAN_THREADS > 0 ? TSPROCESS_SCAN_THREADS : std::thread::hardware_concurrency();
+    for (unsigned i = 1; i < thread_count; ++i) {
+      threads_.emplace_back([this] { worker_loop(); });
+    }
+  }
+
+  ~Pool() {
+    {
+      std::lock_guard lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+  }
+
+  std::size_t participants() const {
+    return threads_.size() + 1;
+  }
+
+  void run(std::size_t count, const scan_pool::Task &task, const std::atomic<bool> *cancel) {
+    if (count == 0) {
+      return;
+    }
+
+    const auto job = std::make_shared<Job>(&task, cancel, std::min(count, participants()));
+    for (std::size_t item = 0; item < count; ++item) {
+      job->queues[item % job->queues.size()].items.push_back(item);
+    }
+    job->remaining.store(count, std::memory_order_relaxed);
+
+    const auto slot = job->next_slot.fetch_add(1);
+
+    if (count > 1 && !threads_.empty()) {
+      {
+        std::lock_guard lock(mutex_);
+        jobs_.push_back(job);
+      }
+      wake_.notify_all();
+    }
+
+    job->work(slot);
+    retire(job);
+
+    std::unique_lock lock(job->done_mutex);
+    job->done.wait(lock, [&job] { return job->remaining.load(std::memory_order_acquire) == 0; });
+  }
+
+ private:
+  void retire(const std::shared_ptr<Job> &job) {
+    std::lock_guard lock(mutex_);
+    const auto it = std::find(jobs_.begin(), jobs_.end(), job);
+    if (it != jobs_.end()) {
+      jobs_.erase(it);
+    }
+  }
+
+  void worker_loop() {
+    while (true) {
+      std::shared_ptr<Job> job;
+      {
+        std::unique_lock lock(mutex_);
+        wake_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+        if (stopping_) {
+          return;
+        }
+        job = jobs_.front();
+      }
+
+      job->work(job->next_slot.fetch_add(1));
+
+      // Every queue is empty at this point, so nobody else needs to pick this job up
+      retire(job);
+    }
+  }
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<std::shared_ptr<Job>> jobs_;
+  bool stopping_ = false;
+};
+
+Pool &pool() {
+  static Pool instance;
+  return instance;
+}
+
+}  // namespace
+
+std::size_t scan_pool::participants() {
+  return pool().participants();
+}
+
+void scan_pool::run(std::size_t count, const Task &task, const std::atomic<bool> *cancel) {
+  pool().run(count, task, cancel);
+}
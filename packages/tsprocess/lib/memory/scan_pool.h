@@ -0,0 +1,20 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+namespace scan_pool {
+
+using Task = std::function<void(std::size_t item, std::size_t worker)>;
+
+// Upper bound of `worker` values passed to a task, the calling thread included.
+std::size_t participants();
+
+// Runs task(item, worker) for every item in [0, count) on the shared worker pool and returns once all of them are done.
+// The calling thread takes part in the work. Items are dealt round-robin into per-worker queues that are drained lowest
+// index first, idle workers steal from the back of the other queues. Once `cancel` is set the remaining items are
+// dropped without running.
+void run(std::size_t count, const Task &task, const std::atomic<bool> *cancel = nullptr);
+
+}  // namespace scan_pool
@@ -0,0 +1,578 @@
+#include "scanner.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <map>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TSPROCESS_SCANNER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TSPROCESS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define TSPROCESS_TARGET(isa)
+#endif
+
+namespace {
+
+constexpr std::array<uint8_t, 256> make_frequency_table() {
+  std::array<uint8_t, 256> table{};
+  for (auto &value : table) {
+    value = 32;
+  }
+
+  // Zero padding, small integers and pointer bytes dominate heaps
+  table[0x00] = 255;
+  table[0xFF] = 220;
+  table[0x01] = 160;
+  table[0x02] = 120;
+  table[0x04] = 120;
+  table[0x08] = 120;
+  table[0x10] = 110;
+  table[0x20] = 100;
+  table[0x40] = 100;
+  table[0x80] = 90;
+  table[0x7F] = 90;
+
+  // Common x86 opcodes, prefixes and modrm bytes
+  table[0x8B] = 200;
+  table[0x48] = 190;
+  table[0x89] = 180;
+  table[0xE8] = 150;
+  table[0x0F] = 140;
+  table[0x85] = 130;
+  table[0x83] = 130;
+  table[0x74] = 120;
+  table[0x75] = 120;
+  table[0x4C] = 110;
+  table[0x45] = 100;
+  table[0x24] = 100;
+  table[0xC3] = 90;
+  table[0xCC] = 90;
+  table[0x90] = 90;
+  table[0x55] = 80;
+  table[0x5D] = 80;
+  table[0xEC] = 80;
+  table[0xC0] = 80;
+  table[0x33] = 70;
+  table[0xD2] = 70;
+  table[0x8D] = 70;
+  table[0x50] = 60;
+  table[0x44] = 60;
+  table[0x0D] = 60;
+  table[0x05] = 60;
+  table[0x15] = 60;
+  table[0x3D] = 50;
+
+  return table;
+}
+
+constexpr auto frequency_table = make_frequency_table();
+
+template <bool NonZeroMask>
+inline bool verify(const scanner::CompiledPattern &pattern, const uint8_t *data) {
+  const auto signature = pattern.signature().data();
+  for (const auto position : pattern.exact_positions()) {
+    if (data[position] != signature[position]) {
+      return false;
+    }
+  }
+
+  if constexpr (NonZeroMask) {
+    for (const auto position : pattern.non_zero_positions()) {
+      if (data[position] == 0) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+template <bool NonZeroMask>
+size_t find_tail(const scanner::CompiledPattern &pattern, const uint8_t *data, size_t first, size_t last) {
+  const auto first_anchor = pattern.anchor_first();
+  const auto second_anchor = pattern.anchor_second();
+  const auto first_byte = pattern.signature()[first_anchor];
+  const auto second_byte = pattern.signature()[second_anchor];
+
+  for (size_t i = first; i <= last; ++i) {
+    if (data[i + first_anchor] == first_byte && data[i + second_anchor] == second_byte &&
+        verify<NonZeroMask>(pattern, data + i)) {
+      return i;
+    }
+  }
+
+  return scanner::CompiledPattern::npos;
+}
+
+#ifdef TSPROCESS_SCANNER_X86
+
+// Every kernel tests the two anchor bytes for a whole vector of start positions at once and only runs the full
+// verification for positions where both anchors matched.
+
+template <bool NonZeroMask>
+TSPROCESS_TARGET("sse2")
+size_t find_sse2(const scanner::CompiledPattern &pattern, const uint8_t *data, size_t start, size_t last) {
+  const auto first_anchor = pattern.anchor_first();
+  const auto second_anchor = pattern.anchor_second();
+  const auto first_byte = _mm_set1_epi8(static_cast<char>(pattern.signature()[first_anchor]));
+  const auto second_byte = _mm_set1_epi8(static_cast<char>(pattern.signature()[second_anchor]));
+
+  auto i = start;
+  for (; i + 16 <= last + 1; i += 16) {
+    const auto first_block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + first_anchor));
+    const auto second_block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + second_anchor));
+    auto candidates = static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first_block, first_byte), _mm_cmpeq_epi8(second_block, second_byte)))
+    );
+
+    while (candidates != 0) {
+      const auto position = i + std::countr_zero(candidates);
+      if (verify<NonZeroMask>(pattern, data + position)) {
+        return position;
+      }
+      candidates &= candidates - 1;
+    }
+  }
+
+  return find_tail<NonZeroMask>(pattern, data, i, last);
+}
+
+template <bool NonZeroMask>
+TSPROCESS_TARGET("avx2")
+size_t find_avx2(const scanner::CompiledPattern &pattern, const uint8_t *data, size_t start, size_t last) {
+  const auto first_anchor = pattern.anchor_first();
+  const auto second_anchor = pattern.anchor_second();
+  const auto first_byte = _mm256_set1_epi8(static_cast<char>(pattern.signature()[first_anchor]));
+  const auto second_byte = _mm256_set1_epi8(static_cast<char>(pattern.signature()[second_anchor]));
+
+  auto i = start;
+  for (; i + 32 <= last + 1; i += 32) {
+    const auto first_block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + first_anchor));
+    const auto second_block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + second_anchor));
+    auto candidates = static_cast<uint32_t>(_mm256_movemask_epi8(
+      _mm256_and_si256(_mm256_cmpeq_epi8(first_block, first_byte), _mm256_cmpeq_epi8(second_block, second_byte))
+    ));
+
+    while (candidates != 0) {
+      const auto position = i + std::countr_zero(candidates);
+      if (verify<NonZeroMask>(pattern, data + position)) {
+        return position;
+      }
+      candidates &= candidates - 1;
+    }
+  }
+
+  return find_tail<NonZeroMask>(pattern, data, i, last);
+}
+
+template <bool NonZeroMask>
+TSPROCESS_TARGET("avx512f,avx512bw")
+size_t find_avx512(const scanner::CompiledPattern &pattern, const uint8_t *data, size_t start, size_t last) {
+  const auto first_anchor = pattern.anchor_first();
+  const auto second_anchor = pattern.anchor_second();
+  const auto first_byte = _mm512_set1_epi8(static_cast<char>(pattern.signature()[first_anchor]));
+  const auto second_byte = _mm512_set1_epi8(static_cast<char>(pattern.signature()[second_anchor]));
+
+  auto i = start;
+  for (; i + 64 <= last + 1; i += 64) {
+    const auto first_block = _mm512_loadu_si512(data + i + first_anchor);
+    const auto second_block = _mm512_loadu_si512(data + i + second_anchor);
+    auto candidates = static_cast<uint64_t>(
+      _mm512_cmpeq_epi8_mask(first_block, first_byte) & _mm512_cmpeq_epi8_mask(second_block, second_byte)
+    );
+
+    while (candidates != 0) {
+      const auto position = i + std::countr_zero(candidates);
+      if (verify<NonZeroMask>(pattern, data + position)) {
+        return position;
+      }
+      candidates &= candidates - 1;
+    }
+  }
+
+  return find_tail<NonZeroMask>(pattern, data, i, last);
+}
+
+// Shufti: the bucket bits of a byte are the AND of a lookup by its low nibble and one by its high nibble, done for 32
+// positions per instruction with vpshufb. The result is a superset of the exact table lookup and is verified later.
+template <class F>
+TSPROCESS_TARGET("avx2")
+size_t multi_candidates_avx2(
+  const uint8_t *data,
+  size_t size,
+  const scanner::MultiPattern::Tables &tables,
+  F &&on_candidate
+) {
+  const auto nibble = _mm256_set1_epi8(0x0F);
+  const auto zero = _mm256_setzero_si256();
+  const auto first_low =
+    _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&tables.first_low)));
+  const auto first_high =
+    _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&tables.first_high)));
+  const auto second_low =
+    _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&tables.second_low)));
+  const auto second_high =
+    _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&tables.second_high)));
+
+  alignas(32) uint8_t buckets[32];
+
+  size_t i = 0;
+  for (; i + 33 <= size; i += 32) {
+    const auto first_block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    const auto second_block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 1));
+
+    const auto first_bits = _mm256_and_si256(
+      _mm256_shuffle_epi8(first_low, _mm256_and_si256(first_block, nibble)),
+      _mm256_shuffle_epi8(first_high, _mm256_and_si256(_mm256_srli_epi16(first_block, 4), nibble))
+    );
+    const auto second_bits = _mm256_and_si256(
+      _mm256_shuffle_epi8(second_low, _mm256_and_si256(second_block, nibble)),
+      _mm256_shuffle_epi8(second_high, _mm256_and_si256(_mm256_srli_epi16(second_block, 4), nibble))
+    );
+    const auto bits = _mm256_and_si256(first_bits, second_bits);
+
+    auto candidates = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bits, zero)));
+    if (candidates == 0) {
+      continue;
+    }
+
+    _mm256_store_si256(reinterpret_cast<__m256i *>(buckets), bits);
+    while (candidates != 0) {
+      const auto position = std::countr_zero(candidates);
+      on_candidate(i + position, buckets[position]);
+      candidates &= candidates - 1;
+    }
+  }
+
+  return i;
+}
+
+scanner::Isa query_cpu() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  const auto max_leaf = info[0];
+
+  __cpuid(info, 1);
+  const bool sse2 = (info[3] & (1 << 26)) != 0;
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  if (!sse2) {
+    return scanner::Isa::scalar;
+  }
+  if (!osxsave || max_leaf < 7) {
+    return scanner::Isa::sse2;
+  }
+
+  const auto xcr0 = _xgetbv(0);
+  const bool ymm_state = (xcr0 & 0x6) == 0x6;
+  const bool zmm_state = (xcr0 & 0xE6) == 0xE6;
+
+  __cpuidex(info, 7, 0);
+  const bool avx2 = (info[1] & (1 << 5)) != 0;
+  const bool avx512 = (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;
+
+  if (avx512 && zmm_state) {
+    return scanner::Isa::avx512;
+  }
+  if (avx2 && ymm_state) {
+    return scanner::Isa::avx2;
+  }
+  return scanner::Isa::sse2;
+#else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+    return scanner::Isa::avx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return scanner::Isa::avx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return scanner::Isa::sse2;
+  }
+  return scanner::Isa::scalar;
+#endif
+}
+
+#else
+
+scanner::Isa query_cpu() {
+  return scanner::Isa::scalar;
+}
+
+#endif
+
+std::atomic<scanner::Isa> &selected_isa() {
+  static std::atomic<scanner::Isa> isa{scanner::detect_isa()};
+  return isa;
+}
+
+template <bool NonZeroMask>
+size_t dispatch(const scanner::CompiledPattern &pattern, const uint8_t *data, size_t start, size_t last) {
+#ifdef TSPROCESS_SCANNER_X86
+  switch (selected_isa().load(std::memory_order_relaxed)) {
+    case scanner::Isa::avx512:
+      return find_avx512<NonZeroMask>(pattern, data, start, last);
+    case scanner::Isa::avx2:
+      return find_avx2<NonZeroMask>(pattern, data, start, last);
+    case scanner::Isa::sse2:
+      return find_sse2<NonZeroMask>(pattern, data, start, last);
+    case scanner::Isa::scalar:
+      break;
+  }
+#endif
+  return find_tail<NonZeroMask>(pattern, data, start, last);
+}
+
+}  // namespace
+
+scanner::Isa scanner::detect_isa() {
+  static const auto isa = query_cpu();
+  return isa;
+}
+
+scanner::Isa scanner::active_isa() {
+  return selected_isa().load(std::memory_order_relaxed);
+}
+
+void scanner::set_isa(Isa isa) {
+  selected_isa().store(std::min(isa, detect_isa()), std::memory_order_relaxed);
+}
+
+uint8_t scanner::byte_frequency(uint8_t value) {
+  return frequency_table[value];
+}
+
+scanner::CompiledPattern::CompiledPattern(
+  std::span<const uint8_t> signature,
+  std::span<const uint8_t> mask,
+  bool non_zero_mask
+)
+    : signature_(signature.begin(), signature.end()), non_zero_mask_(non_zero_mask) {
+  mask_.resize(signature.size(), 1);
+  std::copy_n(mask.begin(), std::min(mask.size(), signature.size()), mask_.begin());
+
+  for (uint32_t j = 0; j < signature_.size(); ++j) {
+    if (!non_zero_mask_) {
+      if (mask_[j] != 0) {
+        exact_.push_back(j);
+      }
+      continue;
+    }
+
+    if (mask_[j] == 1) {
+      exact_.push_back(j);
+    } else if (mask_[j] == 0) {
+      non_zero_.push_back(j);
+    } else {
+      impossible_ = true;
+    }
+  }
+
+  if (exact_.empty()) {
+    return;
+  }
+
+  // Verify the rarest bytes first so mismatching candidates are rejected early
+  std::stable_sort(exact_.begin(), exact_.end(), [this](uint32_t a, uint32_t b) {
+    return byte_frequency(signature_[a]) < byte_frequency(signature_[b]);
+  });
+
+  anchor_first_ = exact_[0];
+  anchor_second_ = exact_.size() > 1 ? exact_[1] : exact_[0];
+}
+
+bool scanner::CompiledPattern::matches_at(const uint8_t *data) const {
+  if (impossible_) {
+    return false;
+  }
+
+  return non_zero_mask_ ? verify<true>(*this, data) : verify<false>(*this, data);
+}
+
+size_t scanner::CompiledPattern::find(std::span<const uint8_t> buffer, size_t start) const {
+  if (signature_.empty()) {
+    return start <= buffer.size() ? start : npos;
+  }
+
+  if (impossible_ || buffer.size() < signature_.size()) {
+    return npos;
+  }
+
+  const auto last = buffer.size() - signature_.size();
+  if (start > last) {
+    return npos;
+  }
+
+  if (unanchored()) {
+    for (auto i = start; i <= last; ++i) {
+      if (matches_at(buffer.data() + i)) {
+        return i;
+      }
+    }
+    return npos;
+  }
+
+  return non_zero_mask_ ? dispatch<true>(*this, buffer.data(), start, last)
+                        : dispatch<false>(*this, buffer.data(), start, last);
+}
+
+scanner::MultiPattern::MultiPattern(std::vector<CompiledPattern> patterns) : patterns_(std::move(patterns)) {
+  for (uint32_t i = 0; i < patterns_.size(); ++i) {
+    const auto &pattern = patterns_[i];
+    max_size_ = std::max(max_size_, pattern.size());
+
+    if (pattern.impossible()) {
+      continue;
+    }
+
+    if (pattern.unanchored()) {
+      unanchored_.push_back(i);
+      continue;
+    }
+
+    const auto &signature = pattern.signature();
+    const auto &mask = pattern.mask();
+    const auto is_exact = [&](uint32_t j) {
+      return pattern.non_zero_mask() ? mask[j] == 1 : mask[j] != 0;
+    };
+
+    // Prefer the adjacent exact pair with the rarest bytes, fall back to the single rarest byte
+    auto anchor = Anchor{i, pattern.anchor_first(), signature[pattern.anchor_first()], 0, false};
+    auto best_score = 0xFFFF;
+    for (uint32_t j = 0; j + 1 < signature.size(); ++j) {
+      if (!is_exact(j) || !is_exact(j + 1)) {
+        continue;
+      }
+
+      const auto score = byte_frequency(signature[j]) + byte_frequency(signature[j + 1]);
+      if (score < best_score) {
+        best_score = score;
+        anchor = Anchor{i, j, signature[j], signature[j + 1], true};
+      }
+    }
+
+    anchors_.push_back(anchor);
+  }
+
+  // Anchors sharing a first byte go into the same bucket. Single byte anchors get their own bucket so they do not
+  // disable the second byte filter of the pairs.
+  const auto has_single = std::any_of(anchors_.begin(), anchors_.end(), [](const Anchor &anchor) { return !anchor.pair; });
+  const auto pair_buckets = has_single ? 7u : 8u;
+
+  auto first_byte_buckets = std::map<uint8_t, uint32_t>();
+  for (uint32_t i = 0; i < anchors_.size(); ++i) {
+    const auto &anchor = anchors_[i];
+
+    auto bucket = 7u;
+    if (anchor.pair) {
+      const auto [it, inserted] =
+        first_byte_buckets.try_emplace(anchor.first, static_cast<uint32_t>(first_byte_buckets.size() % pair_buckets));
+      bucket = it->second;
+    }
+
+    buckets_[bucket].push_back(i);
+
+    const auto bit = static_cast<uint8_t>(1u << bucket);
+    tables_.first[anchor.first] |= bit;
+    tables_.first_low[anchor.first & 0x0F] |= bit;
+    tables_.first_high[anchor.first >> 4] |= bit;
+
+    if (anchor.pair) {
+      tables_.second[anchor.second] |= bit;
+      tables_.second_low[anchor.second & 0x0F] |= bit;
+      tables_.second_high[anchor.second >> 4] |= bit;
+    } else {
+      tables_.single |= bit;
+    }
+  }
+
+  for (auto &bits : tables_.second) {
+    bits |= tables_.single;
+  }
+  for (size_t i = 0; i < 16; ++i) {
+    tables_.second_low[i] |= tables_.single;
+    tables_.second_high[i] |= tables_.single;
+  }
+}
+
+void scanner::MultiPattern::verify_candidate(
+  std::span<const uint8_t> buffer,
+  std::size_t limit,
+  std::size_t position,
+  uint8_t buckets,
+  std::vector<uint8_t> &active,
+  const MatchCallback &on_match
+) const {
+  while (buckets != 0) {
+    const auto bucket = std::countr_zero(buckets);
+    buckets &= buckets - 1;
+
+    for (const auto index : buckets_[bucket]) {
+      const auto &anchor = anchors_[index];
+      if (!active[anchor.pattern] || buffer[position] != anchor.first || position < anchor.offset) {
+        continue;
+      }
+
+      if (anchor.pair && (position + 1 >= buffer.size() || buffer[position + 1] != anchor.second)) {
+        continue;
+      }
+
+      const auto &pattern = patterns_[anchor.pattern];
+      const auto start = position - anchor.offset;
+      if (start >= limit || start + pattern.size() > buffer.size()) {
+        continue;
+      }
+
+      if (pattern.matches_at(buffer.data() + start)) {
+        on_match(anchor.pattern, start);
+      }
+    }
+  }
+}
+
+void scanner::MultiPattern::scan(
+  std::span<const uint8_t> buffer,
+  std::size_t limit,
+  std::vector<uint8_t> &active,
+  const MatchCallback &on_match
+) const {
+  const auto on_candidate = [&](size_t position, uint8_t buckets) {
+    verify_candidate(buffer, limit, position, buckets, active, on_match);
+  };
+
+  size_t position = 0;
+
+#ifdef TSPROCESS_SCANNER_X86
+  if (active_isa() >= Isa::avx2) {
+    position = multi_candidates_avx2(buffer.data(), buffer.size(), tables_, on_candidate);
+  }
+#endif
+
+  for (; position < buffer.size(); ++position) {
+    const auto second = position + 1 < buffer.size() ? tables_.second[buffer[position + 1]] : tables_.single;
+    const auto buckets = static_cast<uint8_t>(tables_.first[buffer[position]] & second);
+    if (buckets != 0) {
+      on_candidate(position, buckets);
+    }
+  }
+
+  for (const auto index : unanchored_) {
+    const auto &pattern = patterns_[index];
+    const auto window = buffer.first(std::min(buffer.size(), limit + (pattern.empty() ? 0 : pattern.size() - 1)));
+
+    auto offset = pattern.find(window);
+    while (active[index] && offset != CompiledPattern::npos) {
+      on_match(index, offset);
+      offset = pattern.empty() ? CompiledPattern::npos : pattern.find(window, offset + 1);
+    }
+  }
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace scanner {
+
+enum class Isa : uint8_t { scalar, sse2, avx2, avx512 };
+
+// Highest instruction set usable by the scan kernels on this machine.
+Isa detect_isa();
+
+// Instruction set the kernels currently dispatch to, defaults to detect_isa().
+Isa active_isa();
+
+// Forces a specific kernel (clamped to detect_isa()), mostly useful to compare against the scalar path.
+void set_isa(Isa isa);
+
+// Byte-at-a-time matcher, kept as the reference implementation for the vectorized kernels.
+// mask[j] == 1 requires buffer[i + j] == signature[j]; mask[j] == 0 is a wildcard, or with non_zero_mask
+// a byte that must not be zero.
+inline bool scan_reference(
+  std::span<const uint8_t> buffer,
+  std::span<const uint8_t> signature,
+  std::span<const uint8_t> mask,
+  size_t &offset,
+  bool non_zero_mask
+) {
+  offset = 0;
+
+  for (size_t i = 0; i + signature.size() <= buffer.size(); ++i) {
+    bool found = true;
+    for (size_t j = 0; j < signature.size(); ++j) {
+      if (non_zero_mask) {
+        if ((buffer[i + j] == signature[j] && mask[j] == 1) || (mask[j] == 0 && buffer[i + j] != 0)) {
+          continue;
+        }
+      } else {
+        if (buffer[i + j] == signature[j] || mask[j] == 0) {
+          continue;
+        }
+      }
+
+      found = false;
+      break;
+    }
+
+    if (!found) {
+      continue;
+    }
+
+    offset = static_cast<size_t>(i);
+    return true;
+  }
+
+  return false;
+}
+
+// Signature preprocessed for repeated scanning: the per-byte mask semantics are resolved into position lists once, and
+// the two rarest exact bytes are picked as anchors for the vector prefilter.
+class CompiledPattern {
+ public:
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  CompiledPattern(std::span<const uint8_t> signature, std::span<const uint8_t> mask, bool non_zero_mask);
+
+  // Offset of the first match starting at or after `start`, or npos.
+  size_t find(std::span<const uint8_t> buffer, size_t start = 0) const;
+
+  // Checks the whole pattern at `data`, which must have at least size() readable bytes.
+  bool matches_at(const uint8_t *data) const;
+
+  size_t size() const {
+    return signature_.size();
+  }
+
+  bool empty() const {
+    return signature_.empty();
+  }
+
+  bool non_zero_mask() const {
+    return non_zero_mask_;
+  }
+
+  const std::vector<uint8_t> &signature() const {
+    return signature_;
+  }
+
+  const std::vector<uint8_t> &mask() const {
+    return mask_;
+  }
+
+  const std::vector<uint32_t> &exact_positions() const {
+    return exact_;
+  }
+
+  const std::vector<uint32_t> &non_zero_positions() const {
+    return non_zero_;
+  }
+
+  // Positions of the anchor bytes, equal when the pattern has a single exact byte.
+  uint32_t anchor_first() const {
+    return anchor_first_;
+  }
+
+  uint32_t anchor_second() const {
+    return anchor_second_;
+  }
+
+  // True when the pattern has no exact byte to anchor on and has to go through the reference matcher.
+  bool unanchored() const {
+    return exact_.empty();
+  }
+
+  // True when the mask contains values the reference matcher can never satisfy.
+  bool impossible() const {
+    return impossible_;
+  }
+
+ private:
+  std::vector<uint8_t> signature_;
+  std::vector<uint8_t> mask_;
+  std::vector<uint32_t> exact_;
+  std::vector<uint32_t> non_zero_;
+  uint32_t anchor_first_ = 0;
+  uint32_t anchor_second_ = 0;
+  bool non_zero_mask_ = false;
+  bool impossible_ = false;
+};
+
+// Set of compiled patterns matched in a single pass over a buffer. Every pattern is anchored on its rarest pair of
+// adjacent exact bytes, the anchors are spread over 8 buckets and candidate positions for all buckets are located at
+// once through nibble lookup tables, so a pass costs about the same for 1 or 50 patterns.
+class MultiPattern {
+ public:
+  using MatchCallback = std::function<void(std::size_t pattern, std::size_t offset)>;
+
+  explicit MultiPattern(std::vector<CompiledPattern> patterns);
+
+  // Reports matches of every pattern with active[pattern] != 0 that start below `limit`, in ascending offset order per
+  // pattern. The callback may clear active[pattern] to stop further reports of that pattern during this pass.
+  void scan(
+    std::span<const uint8_t> buffer,
+    std::size_t limit,
+    std::vector<uint8_t> &active,
+    const MatchCallback &on_match
+  ) const;
+
+  const std::vector<CompiledPattern> &patterns() const {
+    return patterns_;
+  }
+
+  std::size_t max_size() const {
+    return max_size_;
+  }
+
+  struct Anchor {
+    uint32_t pattern;
+    uint32_t offset;
+    uint8_t first;
+    uint8_t second;
+    bool pair;
+  };
+
+  struct Tables {
+    // Bucket bits of the first and second anchor byte, split by low and high nibble for the vector kernels
+    std::array<uint8_t, 16> first_low;
+    std::array<uint8_t, 16> first_high;
+    std::array<uint8_t, 16> second_low;
+    std::array<uint8_t, 16> second_high;
+    // Exact bucket bits per byte value for the scalar path
+    std::array<uint8_t, 256> first;
+    std::array<uint8_t, 256> second;
+    // Buckets whose anchors do not look at the second byte
+    uint8_t single;
+  };
+
+ private:
+  void verify_candidate(
+    std::span<const uint8_t> buffer,
+    std::size_t limit,
+    std::size_t position,
+    uint8_t buckets,
+    std::vector<uint8_t> &active,
+    const MatchCallback &on_match
+  ) const;
+
+  std::vector<CompiledPattern> patterns_;
+  std::vector<Anchor> anchors_;
+  std::array<std::vector<uint32_t>, 8> buckets_;
+  std::vector<uint32_t> unanchored_;
+  Tables tables_{};
+  std::size_t max_size_ = 0;
+};
+
+// Rough frequency rank of a byte in x86 code and managed heaps, lower is rarer.
+uint8_t byte_frequency(uint8_t value);
+
+}  // namespace scanner
@@ -0,0 +1,161 @@
+#include "soft_dirty.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <mutex>
+#include <set>
+#include <string>
+#endif
+
+#ifdef __linux__
+
+namespace {
+
+constexpr uint64_t soft_dirty_bit = 1ULL << 55;
+
+std::size_t system_page_size() {
+  static const auto size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+bool write_clear_refs(int fd) {
+  // 4 clears the soft-dirty bits
+  return write(fd, "4", 1) == 1;
+}
+
+bool read_entry(int fd, uintptr_t address, uint64_t &entry) {
+  const auto offset = static_cast<off_t>(address / system_page_size() * sizeof(uint64_t));
+  return pread(fd, &entry, sizeof(entry), offset) == sizeof(entry);
+}
+
+// Kernels built without CONFIG_MEM_SOFT_DIRTY accept the clear but never set the bit, which would make every page look
+// clean. Checked once on a page of our own process: clean after a clear, dirty after a write.
+bool kernel_supported() {
+  static const auto supported = [] {
+    const auto pagemap = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+    const auto clear_refs = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+    const auto page = mmap(nullptr, system_page_size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    auto result = false;
+    if (pagemap >= 0 && clear_refs >= 0 && page != MAP_FAILED) {
+      const auto address = reinterpret_cast<uintptr_t>(page);
+      volatile uint8_t *data = static_cast<uint8_t *>(page);
+      data[0] = 1;
+
+      uint64_t clean = 0;
+      uint64_t dirty = 0;
+      result = write_clear_refs(clear_refs) && read_entry(pagemap, address, clean) && (clean & soft_dirty_bit) == 0;
+      data[0] = 2;
+      result = result && read_entry(pagemap, address, dirty) && (dirty & soft_dirty_bit) != 0;
+    }
+
+    if (page != MAP_FAILED) {
+      munmap(page, system_page_size());
+    }
+    if (pagemap >= 0) {
+      close(pagemap);
+    }
+    if (clear_refs >= 0) {
+      close(clear_refs);
+    }
+
+    return result;
+  }();
+
+  return supported;
+}
+
+std::mutex claims_mutex;
+std::set<uint32_t> claims;
+
+}  // namespace
+
+soft_dirty::Tracker::Tracker(void *process) : pid_(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(process))) {
+  if (!kernel_supported()) {
+    return;
+  }
+
+  {
+    std::lock_guard lock(claims_mutex);
+    if (!claims.insert(pid_).second) {
+      return;
+    }
+  }
+
+  const auto directory = "/proc/" + std::to_string(pid_);
+  pagemap_fd_ = open((directory + "/pagemap").c_str(), O_RDONLY | O_CLOEXEC);
+  clear_refs_fd_ = open((directory + "/clear_refs").c_str(), O_WRONLY | O_CLOEXEC);
+  active_ = pagemap_fd_ >= 0 && clear_refs_fd_ >= 0;
+
+  if (!active_) {
+    std::lock_guard lock(claims_mutex);
+    claims.erase(pid_);
+  }
+}
+
+soft_dirty::Tracker::~Tracker() {
+  if (pagemap_fd_ >= 0) {
+    close(pagemap_fd_);
+  }
+  if (clear_refs_fd_ >= 0) {
+    close(clear_refs_fd_);
+  }
+
+  if (active_) {
+    std::lock_guard lock(claims_mutex);
+    claims.erase(pid_);
+  }
+}
+
+std::size_t soft_dirty::Tracker::page_size() const {
+  return system_page_size();
+}
+
+bool soft_dirty::Tracker::query(uintptr_t address, std::size_t size, std::vector<uint8_t> &dirty) {
+  const auto page_size = system_page_size();
+  const auto first = address / page_size;
+  const auto count = size == 0 ? 0 : (address + size - 1) / page_size - first + 1;
+
+  entries_.resize(count);
+  const auto bytes = count * sizeof(uint64_t);
+  const auto offset = static_cast<off_t>(first * sizeof(uint64_t));
+  const auto success = active_ && pread(pagemap_fd_, entries_.data(), bytes, offset) == static_cast<ssize_t>(bytes);
+
+  for (std::size_t i = 0; i < count; ++i) {
+    dirty.push_back(!success || (entries_[i] & soft_dirty_bit) != 0);
+  }
+
+  return success;
+}
+
+bool soft_dirty::Tracker::reset() {
+  return active_ && write_clear_refs(clear_refs_fd_);
+}
+
+#else
+
+soft_dirty::Tracker::Tracker(void *process) {}
+
+soft_dirty::Tracker::~Tracker() {}
+
+std::size_t soft_dirty::Tracker::page_size() const {
+  return 0x1000;
+}
+
+bool soft_dirty::Tracker::query(uintptr_t address, std::size_t size, std::vector<uint8_t> &dirty) {
+  const auto count = size == 0 ? 0 : (address + size - 1) / page_size() - address / page_size() + 1;
+  dirty.insert(dirty.end(), count, 1);
+  return false;
+}
+
+bool soft_dirty::Tracker::reset() {
+  return false;
+}
+
+#endif
+
+bool soft_dirty::Tracker::active() const {
+  return active_;
+}
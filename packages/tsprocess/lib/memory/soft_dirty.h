@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace soft_dirty {
+
+// Learns which pages of a process were written through the kernel's soft-dirty bits (Linux only). Clearing the bits
+// is process wide, so only one tracker can be active per process, the others stay inactive and callers read as usual.
+// Clearing also write-protects every page of the target, which costs it a minor fault on the next write to each page,
+// so tracking is opt-in.
+class Tracker {
+ public:
+  explicit Tracker(void *process);
+  ~Tracker();
+
+  Tracker(const Tracker &) = delete;
+  Tracker &operator=(const Tracker &) = delete;
+
+  // False if the kernel has no soft-dirty support, the process files cannot be opened or another tracker owns the
+  // process.
+  bool active() const;
+
+  std::size_t page_size() const;
+
+  // Sets dirty[i] for every page i of [address, address + size) written since the last reset, appending one byte per
+  // page. Returns false if the page flags could not be read, the pages have to be treated as dirty then.
+  bool query(uintptr_t address, std::size_t size, std::vector<uint8_t> &dirty);
+
+  // Clears the soft-dirty bits of the whole process. A page written after the last query and before the reset is not
+  // reported by the next query, callers have to re-read their pages in full from time to time.
+  bool reset();
+
+ private:
+  uint32_t pid_ = 0;
+  int pagemap_fd_ = -1;
+  int clear_refs_fd_ = -1;
+  bool active_ = false;
+  std::vector<uint64_t> entries_;
+};
+
+}  // namespace soft_dirty
@@ -0,0 +1,237 @@
+#include "stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "tracer.h"
+
+namespace {
+
+// Only ever written by the thread owning the block, so a relaxed load and store is enough and snapshots taken from
+// other threads never see a torn value.
+class Counter {
+ public:
+  void add(uint64_t value) {
+    value_.store(value_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  uint64_t load() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<uint64_t> value_{0};
+};
+
+struct OperationCounters {
+  Counter calls;
+  Counter failures;
+  Counter bytes;
+  Counter syscalls;
+  Counter total_ns;
+  std::array<Counter, stats::latency_buckets> latency;
+};
+
+void accumulate(stats::OperationStats &out, const OperationCounters &counters) {
+  out.calls += counters.calls.load();
+  out.failures += counters.failures.load();
+  out.bytes += counters.bytes.load();
+  out.syscalls += counters.syscalls.load();
+  out.total_ns += counters.total_ns.load();
+  for (std::size_t i = 0; i < stats::latency_buckets; ++i) {
+    out.latency[i] += counters.latency[i].load();
+  }
+}
+
+void subtract(stats::OperationStats &out, const stats::OperationStats &baseline) {
+  out.calls -= baseline.calls;
+  out.failures -= baseline.failures;
+  out.bytes -= baseline.bytes;
+  out.syscalls -= baseline.syscalls;
+  out.total_ns -= baseline.total_ns;
+  for (std::size_t i = 0; i < stats::latency_buckets; ++i) {
+    out.latency[i] -= baseline.latency[i];
+  }
+}
+
+}  // namespace
+
+struct stats::Counters {
+  std::array<OperationCounters, operation_count> operations;
+  Counter bytes_scanned;
+  Counter bytes_skipped;
+};
+
+namespace {
+
+// Blocks are never freed, a thread that exits keeps contributing what it counted. Resets record the current sums as a
+// baseline instead of clearing the blocks, which would race with their owners.
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::pair<void *, std::unique_ptr<stats::Counters>>> blocks;
+  std::map<void *, stats::Snapshot> baselines;
+};
+
+Registry &registry() {
+  static auto instance = new Registry();
+  return *instance;
+}
+
+stats::Snapshot sum(Registry &registry, void *process) {
+  auto result = stats::Snapshot{};
+  for (const auto &[key, counters] : registry.blocks) {
+    if (key != process) {
+      continue;
+    }
+
+    for (std::size_t i = 0; i < stats::operation_count; ++i) {
+      accumulate(result.operations[i], counters->operations[i]);
+    }
+    result.scan.bytes_scanned += counters->bytes_scanned.load();
+    result.scan.bytes_skipped += counters->bytes_skipped.load();
+  }
+
+  return result;
+}
+
+#if TSPROCESS_STATS
+
+std::size_t latency_bucket(uint64_t ns) {
+  return std::min<std::size_t>(std::bit_width(ns), stats::latency_buckets - 1);
+}
+
+stats::Counters *thread_counters(void *process) {
+  thread_local std::vector<std::pair<void *, stats::Counters *>> cache;
+
+  for (const auto &[key, counters] : cache) {
+    if (key == process) {
+      return counters;
+    }
+  }
+
+  auto &instance = registry();
+  std::lock_guard lock(instance.mutex);
+  auto &block = instance.blocks.emplace_back(process, std::make_unique<stats::Counters>());
+  cache.emplace_back(process, block.second.get());
+  return block.second.get();
+}
+
+thread_local stats::Scope *current_scope = nullptr;
+
+#endif
+
+}  // namespace
+
+std::string_view stats::operation_name(Operation operation) {
+  switch (operation) {
+    case Operation::read:
+      return "read";
+    case Operation::read_batch:
+      return "readBatch";
+    case Operation::csharp_string:
+      return "csharpString";
+    case Operation::query_regions:
+      return "queryRegions";
+    case Operation::find_pattern:
+      return "findPattern";
+    case Operation::find_pattern_all:
+      return "findPatternAll";
+    case Operation::batch_find_pattern:
+      return "batchFindPattern";
+    case Operation::scan_chunk:
+      return "scanChunk";
+  }
+
+  return "";
+}
+
+uint64_t stats::latency_quantile(const OperationStats &stats, double fraction) {
+  if (stats.calls == 0) {
+    return 0;
+  }
+
+  const auto target = static_cast<uint64_t>(fraction * static_cast<double>(stats.calls - 1));
+  uint64_t seen = 0;
+  for (std::size_t i = 0; i < latency_buckets; ++i) {
+    seen += stats.latency[i];
+    if (seen > target) {
+      return uint64_t{1} << i;
+    }
+  }
+
+  return uint64_t{1} << (latency_buckets - 1);
+}
+
+stats::Snapshot stats::snapshot(void *process) {
+  auto &instance = registry();
+  std::lock_guard lock(instance.mutex);
+
+  auto result = sum(instance, process);
+  const auto baseline = instance.baselines.find(process);
+  if (baseline != instance.baselines.end()) {
+    for (std::size_t i = 0; i < operation_count; ++i) {
+      subtract(result.operations[i], baseline->second.operations[i]);
+    }
+    result.scan.bytes_scanned -= baseline->second.scan.bytes_scanned;
+    result.scan.bytes_skipped -= baseline->second.scan.bytes_skipped;
+  }
+
+  return result;
+}
+
+void stats::reset(void *process) {
+  auto &instance = registry();
+  std::lock_guard lock(instance.mutex);
+  instance.baselines[process] = sum(instance, process);
+}
+
+#if TSPROCESS_STATS
+
+stats::Scope::Scope(void *process, Operation operation, uint64_t bytes, uintptr_t address)
+    : process_(process),
+      counters_(thread_counters(process)),
+      operation_(operation),
+      bytes_(bytes),
+      address_(address),
+      parent_(current_scope),
+      start_(std::chrono::steady_clock::now()) {
+  current_scope = this;
+}
+
+stats::Scope::~Scope() {
+  const auto end = std::chrono::steady_clock::now();
+  const auto elapsed = end - start_;
+  const auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+  auto &counters = counters_->operations[static_cast<std::size_t>(operation_)];
+  counters.calls.add(1);
+  counters.failures.add(failed_ ? 1 : 0);
+  counters.bytes.add(bytes_);
+  counters.syscalls.add(syscalls_);
+  counters.total_ns.add(ns);
+  counters.latency[latency_bucket(ns)].add(1);
+
+  if (tracer::enabled()) {
+    tracer::record_span(operation_name(operation_).data(), process_, start_, end, bytes_, address_);
+  }
+
+  current_scope = parent_;
+}
+
+void stats::count_syscalls(uint64_t count) {
+  if (current_scope != nullptr) {
+    current_scope->syscalls_ += count;
+  }
+}
+
+void stats::count_scan(void *process, uint64_t scanned, uint64_t skipped) {
+  auto counters = thread_counters(process);
+  counters->bytes_scanned.add(scanned);
+  counters->bytes_skipped.add(skipped);
+}
+
+#endif
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Counters are compiled out when this is 0, every call below then does nothing and snapshots stay empty. Traces then
+// only keep their instant events, spans come from the scopes.
+#ifndef TSPROCESS_STATS
+#define TSPROCESS_STATS 1
+#endif
+
+namespace stats {
+
+enum class Operation : uint8_t {
+  read,
+  read_batch,
+  csharp_string,
+  query_regions,
+  find_pattern,
+  find_pattern_all,
+  batch_find_pattern,
+  // Reading and matching one chunk of a region inside any of the scans above
+  scan_chunk,
+};
+
+constexpr std::size_t operation_count = 8;
+
+// Latencies are counted in power of two buckets, bucket i holds calls that took less than 2^i ns and at least half of
+// that. The last bucket also holds everything slower.
+constexpr std::size_t latency_buckets = 32;
+
+struct OperationStats {
+  uint64_t calls;
+  // Calls that did not fully succeed, a batch counts once however many of its requests failed
+  uint64_t failures;
+  // Bytes requested, scan chunks count the bytes they own
+  uint64_t bytes;
+  // Reads, ioctls and memory syscalls issued while the operation was the innermost one on its thread
+  uint64_t syscalls;
+  uint64_t total_ns;
+  std::array<uint64_t, latency_buckets> latency;
+};
+
+struct ScanStats {
+  uint64_t bytes_scanned;
+  // Bytes of selected regions left out because their pages were not populated or not resident
+  uint64_t bytes_skipped;
+};
+
+struct Snapshot {
+  std::array<OperationStats, operation_count> operations;
+  ScanStats scan;
+};
+
+std::string_view operation_name(Operation operation);
+
+// Upper bound in ns of the bucket the `fraction` quantile of the calls falls into, 0 without calls.
+uint64_t latency_quantile(const OperationStats &stats, double fraction);
+
+// Sum over every thread of the counters recorded for `process` since the last reset. Counters of a handle outlive
+// close_handle until they are reset.
+Snapshot snapshot(void *process);
+void reset(void *process);
+
+// Per thread and process counter block, defined in stats.cc
+struct Counters;
+
+#if TSPROCESS_STATS
+
+// Counts one call of `operation` on `process` and times it until destruction. Counters live in per thread blocks
+// written without atomic read-modify-write, so a scope costs two clock reads and a few plain stores. While the tracer
+// is on the scope is also recorded as a span, `address` only shows up there.
+class Scope {
+ public:
+  Scope(void *process, Operation operation, uint64_t bytes = 0, uintptr_t address = 0);
+  ~Scope();
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+  void fail() {
+    failed_ = true;
+  }
+
+  void add_bytes(uint64_t bytes) {
+    bytes_ += bytes;
+  }
+
+ private:
+  friend void count_syscalls(uint64_t count);
+
+  void *process_;
+  Counters *counters_;
+  Operation operation_;
+  bool failed_ = false;
+  uint64_t bytes_;
+  uint64_t syscalls_ = 0;
+  uintptr_t address_;
+  Scope *parent_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Adds to the innermost scope of the calling thread, if any.
+void count_syscalls(uint64_t count = 1);
+
+// Adds the bytes one scan of `process` read and the ones of its selected regions it left out.
+void count_scan(void *process, uint64_t scanned, uint64_t skipped);
+
+#else
+
+class Scope {
+ public:
+  Scope(void *, Operation, uint64_t = 0, uintptr_t = 0) {}
+  // User provided so scopes that are only constructed do not warn as unused
+  ~Scope() {}
+
+  void fail() {}
+
+  void add_bytes(uint64_t) {}
+};
+
+inline void count_syscalls(uint64_t = 1) {}
+
+inline void count_scan(void *, uint64_t, uint64_t) {}
+
+#endif
+
+}  // namespace stats
@@ -0,0 +1,93 @@
+#include "struct_layout.h"
+
+#include <algorithm>
+#include <cstring>
+#include "memory.h"
+
+namespace {
+
+template <class T>
+double load(const uint8_t *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return static_cast<double>(value);
+}
+
+}  // namespace
+
+struct_layout::Layout struct_layout::compile(std::vector<Field> fields, int bitness) {
+  auto layout = Layout{std::move(fields), 0, 0, static_cast<uint8_t>(bitness == 64 ? 8 : 4)};
+  if (layout.fields.empty()) {
+    return layout;
+  }
+
+  layout.start = UINT32_MAX;
+  for (const auto &field : layout.fields) {
+    layout.start = std::min(layout.start, field.offset);
+    layout.end = std::max(layout.end, field.offset + static_cast<uint32_t>(field_size(layout, field)));
+  }
+
+  return layout;
+}
+
+std::size_t struct_layout::field_size(const Layout &layout, const Field &field) {
+  return type_size(field.type, layout.pointer_size);
+}
+
+std::size_t struct_layout::type_size(FieldType type, uint8_t pointer_size) {
+  switch (type) {
+    case FieldType::i8:
+      return 1;
+    case FieldType::i16:
+      return 2;
+    case FieldType::i32:
+    case FieldType::u32:
+    case FieldType::f32:
+      return 4;
+    case FieldType::i64:
+    case FieldType::f64:
+      return 8;
+    case FieldType::pointer:
+    case FieldType::csharp_string:
+      return pointer_size;
+  }
+
+  return 0;
+}
+
+bool struct_layout::read_span(void *process, const Layout &layout, uintptr_t address, std::vector<uint8_t> &buffer) {
+  buffer.resize(layout.end - layout.start);
+  if (buffer.empty()) {
+    return true;
+  }
+
+  return memory::read_buffer(process, address + layout.start, buffer.size(), buffer.data());
+}
+
+double struct_layout::decode(const Layout &layout, const Field &field, const std::vector<uint8_t> &buffer) {
+  return decode_value(field.type, buffer.data() + (field.offset - layout.start), layout.pointer_size);
+}
+
+double struct_layout::decode_value(FieldType type, const uint8_t *data, uint8_t pointer_size) {
+  switch (type) {
+    case FieldType::i8:
+      return load<int8_t>(data);
+    case FieldType::i16:
+      return load<int16_t>(data);
+    case FieldType::i32:
+      return load<int32_t>(data);
+    case FieldType::u32:
+      return load<uint32_t>(data);
+    case FieldType::f32:
+      return load<float>(data);
+    case FieldType::i64:
+      return load<int64_t>(data);
+    case FieldType::f64:
+      return load<double>(data);
+    case FieldType::pointer:
+    case FieldType::csharp_string:
+      return pointer_size == 8 ? load<uint64_t>(data) : load<uint32_t>(data);
+  }
+
+  return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace struct_layout {
+
+enum class FieldType : uint8_t { i8, i16, i32, u32, f32, i64, f64, pointer, csharp_string };
+
+struct Field {
+  uint32_t offset;
+  FieldType type;
+};
+
+// Fields of one object, read together as the byte span [start, end) relative to the object address.
+struct Layout {
+  std::vector<Field> fields;
+  uint32_t start;
+  uint32_t end;
+  uint8_t pointer_size;
+};
+
+Layout compile(std::vector<Field> fields, int bitness);
+
+// Size of the field inside the object, C# strings are stored as a pointer.
+std::size_t field_size(const Layout &layout, const Field &field);
+
+// Reads the whole span of the object at `address` with one read into `buffer`, which is resized to fit.
+bool read_span(void *process, const Layout &layout, uintptr_t address, std::vector<uint8_t> &buffer);
+
+// Decodes a numeric field (or the pointer of a string field) from a buffer filled by read_span.
+double decode(const Layout &layout, const Field &field, const std::vector<uint8_t> &buffer);
+
+// Decodes a single value of `type` stored at `data`.
+double decode_value(FieldType type, const uint8_t *data, uint8_t pointer_size);
+
+std::size_t type_size(FieldType type, uint8_t pointer_size);
+
+}  // namespace struct_layout
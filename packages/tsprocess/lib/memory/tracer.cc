@@ -0,0 +1,251 @@
+#include "tracer.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+enum class Phase : uint8_t { span, instant };
+
+struct RawEvent {
+  const char *name;
+  uint64_t process;
+  uint64_t thread;
+  uint64_t start_ns;
+  uint64_t duration_ns;
+  uint64_t bytes;
+  uint64_t address;
+  int32_t pattern;
+  Phase phase;
+};
+
+// Fields are relaxed atomics so a dump racing a writer reads stale values instead of tearing. `sequence` is 0 while
+// the slot is written and the event number plus one once it is complete, a dump keeps slots that match before and after
+// copying them.
+struct Slot {
+  std::atomic<uint64_t> sequence{0};
+  std::atomic<const char *> name{nullptr};
+  std::atomic<uint64_t> process{0};
+  std::atomic<uint64_t> thread{0};
+  std::atomic<uint64_t> start_ns{0};
+  std::atomic<uint64_t> duration_ns{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<uint64_t> address{0};
+  std::atomic<int32_t> pattern{0};
+  std::atomic<Phase> phase{Phase::span};
+};
+
+struct Ring {
+  explicit Ring(std::size_t capacity) : slots(capacity) {}
+
+  std::vector<Slot> slots;
+  std::atomic<uint64_t> next{0};
+  // Start of the trace in steady clock ticks, atomic since writers may still be reading it while a restart sets it
+  std::atomic<std::chrono::steady_clock::rep> origin{0};
+};
+
+// Replaced rings are kept alive, a writer that loaded one just before the swap may still be writing into it. A ring is
+// only replaced when the capacity changes, so at most a handful ever leak.
+std::atomic<Ring *> current_ring = nullptr;
+std::mutex control_mutex;
+
+uint64_t thread_number() {
+  static std::atomic<uint64_t> next = 1;
+  thread_local const auto number = next.fetch_add(1, std::memory_order_relaxed);
+  return number;
+}
+
+std::chrono::steady_clock::time_point origin(const Ring &ring) {
+  return std::chrono::steady_clock::time_point(
+    std::chrono::steady_clock::duration(ring.origin.load(std::memory_order_relaxed))
+  );
+}
+
+uint64_t to_ns(std::chrono::steady_clock::duration duration) {
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  return ns < 0 ? 0 : static_cast<uint64_t>(ns);
+}
+
+void write(Ring &ring, const RawEvent &event) {
+  const auto number = ring.next.fetch_add(1, std::memory_order_relaxed);
+  auto &slot = ring.slots[number % ring.slots.size()];
+
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.name.store(event.name, std::memory_order_relaxed);
+  slot.process.store(event.process, std::memory_order_relaxed);
+  slot.thread.store(event.thread, std::memory_order_relaxed);
+  slot.start_ns.store(event.start_ns, std::memory_order_relaxed);
+  slot.duration_ns.store(event.duration_ns, std::memory_order_relaxed);
+  slot.bytes.store(event.bytes, std::memory_order_relaxed);
+  slot.address.store(event.address, std::memory_order_relaxed);
+  slot.pattern.store(event.pattern, std::memory_order_relaxed);
+  slot.phase.store(event.phase, std::memory_order_relaxed);
+  slot.sequence.store(number + 1, std::memory_order_release);
+}
+
+bool read(const Slot &slot, RawEvent &event) {
+  const auto before = slot.sequence.load(std::memory_order_acquire);
+  if (before == 0) {
+    return false;
+  }
+
+  event.name = slot.name.load(std::memory_order_relaxed);
+  event.process = slot.process.load(std::memory_order_relaxed);
+  event.thread = slot.thread.load(std::memory_order_relaxed);
+  event.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+  event.duration_ns = slot.duration_ns.load(std::memory_order_relaxed);
+  event.bytes = slot.bytes.load(std::memory_order_relaxed);
+  event.address = slot.address.load(std::memory_order_relaxed);
+  event.pattern = slot.pattern.load(std::memory_order_relaxed);
+  event.phase = slot.phase.load(std::memory_order_relaxed);
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.sequence.load(std::memory_order_relaxed) == before;
+}
+
+void append_event(std::string &out, const RawEvent &event) {
+  char buffer[320];
+  const auto us = static_cast<double>(event.start_ns) / 1000.0;
+
+  if (event.phase == Phase::span) {
+    std::snprintf(
+      buffer,
+      sizeof(buffer),
+      "{\"name\":\"%s\",\"cat\":\"tsprocess\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%" PRIu64 ",\"tid\":%" PRIu64
+      ",\"args\":{\"bytes\":%" PRIu64 ",\"address\":\"0x%" PRIx64 "\"}}",
+      event.name,
+      us,
+      static_cast<double>(event.duration_ns) / 1000.0,
+      event.process,
+      event.thread,
+      event.bytes,
+      event.address
+    );
+  } else {
+    std::snprintf(
+      buffer,
+      sizeof(buffer),
+      "{\"name\":\"%s\",\"cat\":\"tsprocess\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%" PRIu64 ",\"tid\":%" PRIu64
+      ",\"args\":{\"address\":\"0x%" PRIx64 "\",\"pattern\":%d}}",
+      event.name,
+      us,
+      event.process,
+      event.thread,
+      event.address,
+      event.pattern
+    );
+  }
+
+  out += buffer;
+}
+
+}  // namespace
+
+void tracer::start(std::size_t capacity) {
+  std::lock_guard lock(control_mutex);
+  active.store(false, std::memory_order_relaxed);
+
+  auto ring = current_ring.load(std::memory_order_acquire);
+  if (ring == nullptr || ring->slots.size() != std::max<std::size_t>(capacity, 1)) {
+    ring = new Ring(std::max<std::size_t>(capacity, 1));
+  } else {
+    for (auto &slot : ring->slots) {
+      slot.sequence.store(0, std::memory_order_relaxed);
+    }
+    ring->next.store(0, std::memory_order_relaxed);
+  }
+
+  ring->origin.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+  current_ring.store(ring, std::memory_order_release);
+  active.store(true, std::memory_order_release);
+}
+
+void tracer::stop() {
+  std::lock_guard lock(control_mutex);
+  active.store(false, std::memory_order_relaxed);
+}
+
+void tracer::record_span(
+  const char *name,
+  void *process,
+  std::chrono::steady_clock::time_point start,
+  std::chrono::steady_clock::time_point end,
+  uint64_t bytes,
+  uintptr_t address
+) {
+  const auto ring = current_ring.load(std::memory_order_acquire);
+  if (ring == nullptr) {
+    return;
+  }
+
+  write(*ring, RawEvent{
+    name,
+    reinterpret_cast<uint64_t>(process),
+    thread_number(),
+    to_ns(start - origin(*ring)),
+    to_ns(end - start),
+    bytes,
+    address,
+    0,
+    Phase::span
+  });
+}
+
+void tracer::record_instant(const char *name, void *process, uintptr_t address, int pattern) {
+  const auto ring = current_ring.load(std::memory_order_acquire);
+  if (ring == nullptr) {
+    return;
+  }
+
+  write(*ring, RawEvent{
+    name,
+    reinterpret_cast<uint64_t>(process),
+    thread_number(),
+    to_ns(std::chrono::steady_clock::now() - origin(*ring)),
+    0,
+    0,
+    address,
+    pattern,
+    Phase::instant
+  });
+}
+
+std::string tracer::dump() {
+  std::lock_guard lock(control_mutex);
+
+  auto events = std::vector<RawEvent>();
+  uint64_t written = 0;
+
+  const auto ring = current_ring.load(std::memory_order_acquire);
+  if (ring != nullptr) {
+    written = ring->next.load(std::memory_order_acquire);
+    events.reserve(std::min<uint64_t>(written, ring->slots.size()));
+
+    for (const auto &slot : ring->slots) {
+      auto event = RawEvent{};
+      if (read(slot, event)) {
+        events.push_back(event);
+      }
+    }
+  }
+
+  std::sort(events.begin(), events.end(), [](const RawEvent &a, const RawEvent &b) {
+    return a.start_ns < b.start_ns;
+  });
+
+  auto out = std::string("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    if (i != 0) {
+      out += ',';
+    }
+    append_event(out, events[i]);
+  }
+
+  const auto dropped = written - std::min<uint64_t>(written, events.size());
+  out += "],\"otherData\":{\"dropped\":" + std::to_string(dropped) + "}}";
+  return out;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef TSPROCESS_TRACE_CAPACITY
+#define TSPROCESS_TRACE_CAPACITY 0x10000
+#endif
+
+// Opt-in timeline of reads and scans. Every stats::Scope becomes a span while tracing is on, scans add an instant event
+// per pattern hit. Events go into a preallocated ring that keeps the newest ones, so a trace never allocates or locks
+// and a disabled tracer costs one relaxed load per scope.
+namespace tracer {
+
+inline std::atomic<bool> active = false;
+
+inline bool enabled() {
+  return active.load(std::memory_order_relaxed);
+}
+
+// Clears the ring and starts recording, the ring is reallocated only when `capacity` changes.
+void start(std::size_t capacity = TSPROCESS_TRACE_CAPACITY);
+void stop();
+
+// `name` must outlive the tracer, string literals only.
+void record_span(
+  const char *name,
+  void *process,
+  std::chrono::steady_clock::time_point start,
+  std::chrono::steady_clock::time_point end,
+  uint64_t bytes,
+  uintptr_t address
+);
+void record_instant(const char *name, void *process, uintptr_t address, int pattern);
+
+inline void instant(const char *name, void *process, uintptr_t address, int pattern) {
+  if (enabled()) {
+    record_instant(name, process, address, pattern);
+  }
+}
+
+// Recorded events in the Chrome trace-event JSON format, which Perfetto and chrome://tracing open as is. Events from
+// different targets land in different process tracks. Can be called while recording, events being written are left out.
+std::string dump();
+
+}  // namespace tracer
@@ -0,0 +1,300 @@
+#include "watcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+watcher::Watcher::Watcher(void *process, std::chrono::milliseconds interval, std::function<void()> notify)
+    : process_(process), notify_(std::move(notify)), interval_(interval) {}
+
+watcher::Watcher::~Watcher() {
+  stop();
+}
+
+uint32_t watcher::Watcher::watch_range(uintptr_t address, std::size_t size) {
+  std::lock_guard lock(mutex_);
+
+  const auto id = next_id_++;
+  entries_.push_back(Entry{id, address, size, {}, false, false, pointer_chain::Status::ok, 0, {}});
+  return id;
+}
+
+uint32_t watcher::Watcher::watch_chain(pointer_chain::Program program) {
+  std::lock_guard lock(mutex_);
+
+  const auto id = next_id_++;
+  entries_.push_back(Entry{id, 0, 0, std::move(program), true, false, pointer_chain::Status::ok, 0, {}});
+  return id;
+}
+
+bool watcher::Watcher::unwatch(uint32_t id) {
+  std::lock_guard lock(mutex_);
+
+  pending_.erase(id);
+
+  const auto entry = std::find_if(entries_.begin(), entries_.end(), [id](const Entry &entry) { return entry.id == id; });
+  if (entry == entries_.end()) {
+    return false;
+  }
+
+  entries_.erase(entry);
+  return true;
+}
+
+void watcher::Watcher::set_interval(std::chrono::milliseconds interval) {
+  {
+    std::lock_guard lock(state_mutex_);
+    interval_ = interval;
+  }
+
+  wake_.notify_all();
+}
+
+bool watcher::Watcher::set_soft_dirty(bool enabled) {
+  std::lock_guard lock(mutex_);
+
+  if (!enabled) {
+    tracker_.reset();
+    return false;
+  }
+
+  if (tracker_ == nullptr) {
+    tracker_ = std::make_unique<soft_dirty::Tracker>(process_);
+    tracker_primed_ = false;
+  }
+
+  if (!tracker_->active()) {
+    tracker_.reset();
+    return false;
+  }
+
+  return true;
+}
+
+watcher::Stats watcher::Watcher::stats() {
+  std::lock_guard lock(mutex_);
+  return Stats{bytes_read_, bytes_skipped_, tracker_ != nullptr};
+}
+
+void watcher::Watcher::start() {
+  std::lock_guard lock(state_mutex_);
+  if (thread_.joinable()) {
+    return;
+  }
+
+  stopping_ = false;
+  thread_ = std::thread(&Watcher::run, this);
+}
+
+void watcher::Watcher::stop() {
+  {
+    std::lock_guard lock(state_mutex_);
+    if (!thread_.joinable()) {
+      return;
+    }
+
+    stopping_ = true;
+  }
+
+  wake_.notify_all();
+  thread_.join();
+}
+
+void watcher::Watcher::run() {
+  auto next = std::chrono::steady_clock::now();
+
+  std::unique_lock lock(state_mutex_);
+  while (!stopping_) {
+    lock.unlock();
+    sample();
+    lock.lock();
+
+    // Keep a steady rate, but do not try to catch up on samples missed while the thread was descheduled
+    const auto now = std::chrono::steady_clock::now();
+    next = std::max(next + interval_, now);
+
+    wake_.wait_until(lock, next, [this] { return stopping_; });
+  }
+}
+
+void watcher::Watcher::sample() {
+  auto should_notify = false;
+
+  {
+    std::lock_guard lock(mutex_);
+
+    requests_.clear();
+    segments_.clear();
+    programs_.clear();
+    dirty_.clear();
+
+    // Page flags are taken right before the bits are cleared. A write landing in between is neither in the flags nor
+    // in the next query, so it is only picked up by the periodic full read.
+    const auto now = std::chrono::steady_clock::now();
+    const auto tracking = tracker_ != nullptr;
+    const auto partial = tracking && tracker_primed_ && now - last_full_read_ < soft_dirty_full_read_interval;
+    if (tracking && !partial) {
+      last_full_read_ = now;
+    }
+    if (partial) {
+      for (const auto &entry : entries_) {
+        if (!entry.is_chain && has_snapshot(entry)) {
+          tracker_->query(entry.address, entry.size, dirty_);
+        }
+      }
+    }
+    if (tracking) {
+      tracker_->reset();
+      tracker_primed_ = true;
+    }
+
+    std::size_t page = 0;
+    for (std::size_t i = 0; i < entries_.size(); ++i) {
+      const auto &entry = entries_[i];
+      if (entry.is_chain) {
+        programs_.push_back(&entry.program);
+        continue;
+      }
+
+      if (!partial || !has_snapshot(entry)) {
+        add_segment(i, 0, entry.size);
+        continue;
+      }
+
+      // One segment per run of written pages
+      const auto page_size = tracker_->page_size();
+      const auto first_page = entry.address / page_size * page_size;
+      const auto pages = (entry.address + entry.size - 1) / page_size - entry.address / page_size + 1;
+      for (std::size_t run = 0; run < pages;) {
+        if (!dirty_[page + run]) {
+          ++run;
+          continue;
+        }
+
+        auto run_end = run;
+        while (run_end < pages && dirty_[page + run_end]) {
+          ++run_end;
+        }
+
+        const auto start = std::max(entry.address, first_page + run * page_size);
+        const auto end = std::min(entry.address + entry.size, first_page + run_end * page_size);
+        add_segment(i, start - entry.address, end - start);
+        run = run_end;
+      }
+      page += pages;
+    }
+
+    std::size_t data_size = 0;
+    for (const auto &segment : segments_) {
+      data_size += segment.size;
+    }
+
+    buffer_.resize(data_size);
+    success_.assign((requests_.size() + 7) / 8, 0);
+    if (!requests_.empty()) {
+      memory::read_batch(process_, requests_, buffer_.data(), success_.data());
+    }
+
+    results_.resize(programs_.size());
+    if (!programs_.empty()) {
+      pointer_chain::evaluate(process_, programs_, results_);
+    }
+
+    std::size_t segment = 0;
+    std::size_t chain = 0;
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < entries_.size(); ++i) {
+      auto &entry = entries_[i];
+      if (entry.is_chain) {
+        const auto &result = results_[chain++];
+        record(entry, result.status, result.value, nullptr);
+        continue;
+      }
+
+      const auto patched = partial && has_snapshot(entry);
+      if (patched) {
+        scratch_ = entry.data;
+      } else {
+        scratch_.resize(entry.size);
+      }
+
+      auto read = true;
+      std::size_t covered = 0;
+      for (; segment < segments_.size() && segments_[segment].entry == i; ++segment) {
+        const auto &item = segments_[segment];
+        if ((success_[segment / 8] >> (segment % 8)) & 1) {
+          std::memcpy(scratch_.data() + item.offset, buffer_.data() + offset, item.size);
+        } else {
+          read = false;
+        }
+
+        offset += item.size;
+        covered += item.size;
+      }
+
+      bytes_read_ += covered;
+      bytes_skipped_ += entry.size - covered;
+
+      // Not a single page of the range was written
+      if (patched && covered == 0) {
+        continue;
+      }
+
+      const auto status = read ? pointer_chain::Status::ok : pointer_chain::Status::read_failed;
+      record(entry, status, 0, read ? scratch_.data() : nullptr);
+    }
+
+    if (!pending_.empty() && !notified_) {
+      notified_ = true;
+      should_notify = true;
+    }
+  }
+
+  if (should_notify && notify_) {
+    notify_();
+  }
+}
+
+void watcher::Watcher::add_segment(std::size_t index, std::size_t offset, std::size_t size) {
+  requests_.push_back(ReadRequest{entries_[index].address + offset, size});
+  segments_.push_back(Segment{index, offset, size});
+}
+
+bool watcher::Watcher::has_snapshot(const Entry &entry) const {
+  return entry.sampled && entry.status == pointer_chain::Status::ok && entry.size > 0 && entry.data.size() == entry.size;
+}
+
+void watcher::Watcher::record(Entry &entry, pointer_chain::Status status, double value, const uint8_t *data) {
+  const auto size = data == nullptr ? 0 : entry.size;
+
+  // Values are compared bitwise so NaN payloads and -0 count as changes like any other byte difference
+  const auto changed = !entry.sampled || entry.status != status ||
+                       std::memcmp(&entry.value, &value, sizeof(value)) != 0 || entry.data.size() != size ||
+                       (size > 0 && std::memcmp(entry.data.data(), data, size) != 0);
+  if (!changed) {
+    return;
+  }
+
+  entry.sampled = true;
+  entry.status = status;
+  entry.value = value;
+  entry.data.assign(data, data + size);
+
+  auto &change = pending_[entry.id];
+  change.id = entry.id;
+  change.status = status;
+  change.value = value;
+  change.data = entry.data;
+}
+
+void watcher::Watcher::take_changes(std::vector<Change> &out) {
+  std::lock_guard lock(mutex_);
+
+  out.clear();
+  out.reserve(pending_.size());
+  for (auto &[id, change] : pending_) {
+    out.push_back(std::move(change));
+  }
+
+  pending_.clear();
+  notified_ = false;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "memory.h"
+#include "pointer_chain.h"
+#include "soft_dirty.h"
+
+#ifndef TSPROCESS_SOFT_DIRTY_FULL_READ_MS
+#define TSPROCESS_SOFT_DIRTY_FULL_READ_MS 1000
+#endif
+
+namespace watcher {
+
+// Upper bound for a watched range, larger areas are better served by readInto
+constexpr std::size_t max_range_size = 0x10000;
+
+// A write landing between the page query and the clear of a sample loses its soft-dirty bit, so tracked watches still
+// read every range in full this often, which bounds how long such a write can stay unreported.
+constexpr auto soft_dirty_full_read_interval = std::chrono::milliseconds(TSPROCESS_SOFT_DIRTY_FULL_READ_MS);
+
+struct Change {
+  uint32_t id;
+  pointer_chain::Status status;
+  // Chain value, 0 for ranges
+  double value;
+  // Range bytes, empty for chains and failed reads
+  std::vector<uint8_t> data;
+};
+
+struct Stats {
+  uint64_t bytes_read;
+  // Range bytes kept from the previous sample because their pages were not written
+  uint64_t bytes_skipped;
+  bool soft_dirty;
+};
+
+// Samples address ranges and pointer chains on its own thread and keeps the entries whose bytes or status changed since
+// the previous sample. Changes are coalesced per entry until they are taken, so a slow consumer only ever sees the
+// latest state of each entry and `notify` fires once per batch instead of once per sample.
+class Watcher {
+ public:
+  Watcher(void *process, std::chrono::milliseconds interval, std::function<void()> notify);
+  ~Watcher();
+
+  Watcher(const Watcher &) = delete;
+  Watcher &operator=(const Watcher &) = delete;
+
+  // Entries are reported on the first sample after being added, ids are never reused.
+  uint32_t watch_range(uintptr_t address, std::size_t size);
+  uint32_t watch_chain(pointer_chain::Program program);
+  bool unwatch(uint32_t id);
+
+  void set_interval(std::chrono::milliseconds interval);
+
+  // Only re-reads the pages of watched ranges written since the previous sample, see soft_dirty::Tracker. Returns
+  // whether tracking is active, ranges are read in full otherwise.
+  bool set_soft_dirty(bool enabled);
+  Stats stats();
+
+  void start();
+  // Joins the sampling thread, no notification is sent after it returns.
+  void stop();
+
+  // Reads every entry once and records the ones that changed.
+  void sample();
+
+  // Moves the pending changes, ordered by id, into `out` and re-arms the notification.
+  void take_changes(std::vector<Change> &out);
+
+ private:
+  struct Entry {
+    uint32_t id;
+    uintptr_t address;
+    std::size_t size;
+    pointer_chain::Program program;
+    bool is_chain;
+    bool sampled;
+    pointer_chain::Status status;
+    double value;
+    std::vector<uint8_t> data;
+  };
+
+  // Part of a range read in this sample
+  struct Segment {
+    std::size_t entry;
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  void run();
+  void record(Entry &entry, pointer_chain::Status status, double value, const uint8_t *data);
+  void add_segment(std::size_t index, std::size_t offset, std::size_t size);
+  bool has_snapshot(const Entry &entry) const;
+
+  void *process_;
+  std::function<void()> notify_;
+
+  // Guards the entries, the pending changes and the sampling buffers
+  std::mutex mutex_;
+  std::vector<Entry> entries_;
+  std::map<uint32_t, Change> pending_;
+  bool notified_ = false;
+  uint32_t next_id_ = 1;
+
+  std::unique_ptr<soft_dirty::Tracker> tracker_;
+  // Set once a sample ran after the soft-dirty bits were cleared, snapshots older than that cannot be trusted
+  bool tracker_primed_ = false;
+  // Last sample that read every range in full, see soft_dirty_full_read_interval
+  std::chrono::steady_clock::time_point last_full_read_;
+  uint64_t bytes_read_ = 0;
+  uint64_t bytes_skipped_ = 0;
+
+  std::vector<Segment> segments_;
+  std::vector<uint8_t> dirty_;
+  std::vector<uint8_t> scratch_;
+  std::vector<ReadRequest> requests_;
+  std::vector<uint8_t> buffer_;
+  std::vector<uint8_t> success_;
+  std::vector<const pointer_chain::Program *> programs_;
+  std::vector<pointer_chain::Result> results_;
+
+  // Guards the interval and the stop flag for the sampling thread
+  std::mutex state_mutex_;
+  std::condition_variable wake_;
+  std::chrono::milliseconds interval_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace watcher
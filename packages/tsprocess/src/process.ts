@@ -16,15 +16,95 @@ export interface ProcessInfo {
     pcPriClassBase: number;
 }
 
+/**
+ * Selects the regions a scan reads, by default readable and writable memory.
+ * Protections are written as any combination of 'r', 'w' and 'x'.
+ */
+export interface RegionFilter {
+    /** Protection a region must have, e.g. 'rx' for JIT code */
+    protection?: string;
+    /** Protection a region must not have */
+    excludeProtection?: string;
+    /** Only memory not backed by a file: heaps, stacks, JIT code */
+    anonymous?: boolean;
+    /** Only regions whose backing file path contains this */
+    path?: string;
+    /** Regions are clipped to [start, end) */
+    start?: number;
+    end?: number;
+    /**
+     * Skip never touched pages of anonymous regions, they read as zeros
+     * (Linux, default true)
+     */
+    skipUnpopulated?: boolean;
+    /**
+     * Only read pages that are in memory, so the scan never pages anything
+     * back in. Matches on swapped out pages are missed (Linux)
+     */
+    residentOnly?: boolean;
+}
+
+export interface ScanStats {
+    bytesScanned: number;
+    /** Bytes of selected regions skipped as unpopulated or not resident */
+    bytesSkipped: number;
+}
+
+export interface OperationStats {
+    calls: number;
+    /** Calls that did not fully succeed */
+    failures: number;
+    bytes: number;
+    /** Syscalls issued by the operation itself, nested operations keep theirs */
+    syscalls: number;
+    totalNs: number;
+    /** Upper bounds of the latency buckets the median and 99th percentile fall into */
+    p50Ns: number;
+    p99Ns: number;
+    /** Call counts per power of two bucket, `latency[i]` took less than 2^i ns */
+    latency: number[];
+}
+
+export interface ProcessStats {
+    read: OperationStats;
+    readBatch: OperationStats;
+    csharpString: OperationStats;
+    queryRegions: OperationStats;
+    findPattern: OperationStats;
+    findPatternAll: OperationStats;
+    batchFindPattern: OperationStats;
+    /** One chunk of a region read and matched by any scan */
+    scanChunk: OperationStats;
+    /** Region bytes read and left out by every scan */
+    scan: ScanStats;
+}
+
+export interface MemoryRegion {
+    address: number;
+    size: number;
+    /** 'rwx' with '-' for missing permissions */
+    protection: string;
+    shared: boolean;
+    anonymous: boolean;
+    /** Offset of the mapping in its backing file */
+    offset: number;
+    inode: number;
+    /** Backing file or a pseudo name such as [heap] */
+    path: string;
+}
+
 export interface Pattern {
     signature: Buffer;
     mask: Buffer;
     nonZeroMask: boolean;
+    all?: boolean;
 }
 
 export interface Signature {
     value: string;
     nonZeroMask: boolean;
+    /** Return every match of this signature instead of only the lowest one */
+    all?: boolean;
 }
 
 export interface PatternResult {
@@ -32,15 +112,537 @@ export interface PatternResult {
     index: number;
 }
 
+/**
+ * Where a Dictionary<K, V> keeps its data, `entries` and `count` are offsets
+ * in the dictionary object, the rest are offsets inside one entry
+ */
+export interface DictionaryLayout {
+    entries: number;
+    count: number;
+    entrySize: number;
+    /** Skip entries with a negative hash code (.NET Framework free list) */
+    hash?: number;
+    /** Skip entries with next < -1 (.NET free list) */
+    next?: number;
+    key: [offset: number, type: FieldType];
+    value: [offset: number, type: FieldType];
+}
+
+export interface SharpDictionary<
+    K extends Float64Array | string[],
+    V extends Float64Array | string[]
+> {
+    /** Position of every entry in the entries array */
+    indices: Uint32Array;
+    /** String typed keys and values are decoded into strings */
+    keys: K;
+    values: V;
+}
+
 export interface DictionaryIntToRefEntry {
     key: number;
     address: number;
 }
 
+/** Value read at the end of a pointer chain */
+export enum ChainType {
+    Byte = 0,
+    Short = 1,
+    Int = 2,
+    UInt = 3,
+    Float = 4,
+    Long = 5,
+    Double = 6,
+    /** Pointer of the process bitness, zero is reported as NullPointer */
+    Pointer = 7
+}
+
+export enum ChainStatus {
+    Ok = 0,
+    NullPointer = 1,
+    ReadFailed = 2,
+    Unmapped = 3,
+    Partial = 4
+}
+
+/** Opaque native program compiled by `Process.compileChain` */
+export type PointerChain = { readonly __brand: 'PointerChain' };
+
+/**
+ * Set of pointer chains evaluated together in one native call. Chains that
+ * start with the same base and offsets share their dereferences, so a common
+ * root like the ruleset is walked once per evaluation.
+ */
+export class PointerChains {
+    private chains: PointerChain[] = [];
+    private values = new Float64Array(0);
+    private statuses = new Uint8Array(0);
+
+    constructor(private process: Process) {}
+
+    get length(): number {
+        return this.chains.length;
+    }
+
+    /**
+     * Adds `[[base + offsets[0]] + ...] + offsets[n - 1]` read as `type`,
+     * returns its index for the getters
+     */
+    add(base: number, offsets: number[], type: ChainType): number {
+        this.chains.push(this.process.compileChain(base, offsets, type));
+
+        if (this.values.length < this.chains.length) {
+            this.values = new Float64Array(this.chains.length * 2);
+            this.statuses = new Uint8Array(this.chains.length * 2);
+        }
+
+        return this.chains.length - 1;
+    }
+
+    /**
+     * Resolves every chain, returns the number of chains with ChainStatus.Ok
+     */
+    evaluate(): number {
+        return this.process.evaluateChains(
+            this.chains,
+            this.values,
+            this.statuses
+        );
+    }
+
+    ok(index: number): boolean {
+        return this.statuses[index] === ChainStatus.Ok;
+    }
+
+    status(index: number): ChainStatus {
+        return this.statuses[index];
+    }
+
+    /** Value of the chain, 0 unless its status is Ok */
+    value(index: number): number {
+        return this.values[index];
+    }
+}
+
+export interface WatchChange {
+    /** Id returned by `MemoryWatch.addRange` or `MemoryWatch.addChain` */
+    id: number;
+    status: ChainStatus;
+    /** Chain value, 0 for ranges */
+    value: number;
+    /** Range bytes, missing for chains and failed reads */
+    data?: Buffer;
+}
+
+export interface WatchStats {
+    bytesRead: number;
+    /** Range bytes reused from the previous sample, their pages were clean */
+    bytesSkipped: number;
+    softDirty: boolean;
+}
+
+/**
+ * Ranges and pointer chains sampled by a native thread every `interval`
+ * milliseconds. `onChange` only runs when something changed and receives the
+ * latest state of every changed entry, so an idle game costs no JS time.
+ * Every entry is reported once right after it is added.
+ */
+export class MemoryWatch {
+    private watch: unknown;
+
+    constructor(
+        private process: Process,
+        interval: number,
+        onChange: (changes: WatchChange[]) => void
+    ) {
+        this.watch = ProcessUtils.createWatch(
+            process.handle,
+            interval,
+            onChange
+        );
+    }
+
+    /** Watches `size` bytes at `address`, at most 64KiB */
+    addRange(address: number, size: number): number {
+        return ProcessUtils.watchRange(
+            this.watch,
+            address,
+            size,
+            this.process.bitness
+        );
+    }
+
+    addChain(base: number, offsets: number[], type: ChainType): number {
+        return ProcessUtils.watchChain(
+            this.watch,
+            this.process.compileChain(base, offsets, type)
+        );
+    }
+
+    remove(id: number): boolean {
+        return ProcessUtils.unwatch(this.watch, id);
+    }
+
+    setInterval(interval: number): void {
+        ProcessUtils.setWatchInterval(this.watch, interval);
+    }
+
+    /**
+     * Linux only: re-reads only the pages of watched ranges that were written
+     * since the previous sample, using the kernel's soft-dirty bits. Clearing
+     * them makes the game take a minor fault on its next write to each page,
+     * so this pays off for large, mostly idle ranges. Ranges are still read
+     * in full once a second, since a write racing the clear is not reported
+     * by the bits. Returns false if the kernel lacks soft-dirty support or
+     * another watch already tracks the process, ranges are read in full then
+     */
+    setSoftDirty(enabled: boolean): boolean {
+        return ProcessUtils.setWatchSoftDirty(this.watch, enabled);
+    }
+
+    stats(): WatchStats {
+        return ProcessUtils.getWatchStats(this.watch);
+    }
+
+    /** Stops the sampling thread, `onChange` is not called afterwards */
+    stop(): void {
+        ProcessUtils.stopWatch(this.watch);
+    }
+}
+
+/** Opaque native channel created by `MemorySampler` */
+export type SamplerChannel = { readonly __brand: 'SamplerChannel' };
+
+export interface SamplerTail {
+    /** Chain to the array object */
+    items: PointerChain;
+    /** Chain to the number of used elements */
+    size: PointerChain;
+    /** Bytes in front of the first element */
+    header: number;
+    type: FieldType;
+    /** Elements outside [min, max] are treated as not written yet */
+    min?: number;
+    max?: number;
+    capacity?: number;
+}
+
+/**
+ * Native thread sampling at a fixed rate into lock-free ring buffers that are
+ * drained once per JS tick, so the sampling rate does not depend on how
+ * often JS gets to run.
+ *
+ * A tail follows an append-only array and yields `[index, value]` pairs for
+ * new elements, index 0 starts a new array. A snapshot yields one row with
+ * the value of every chain (NaN if unresolved) whenever the row changed.
+ */
+export class MemorySampler {
+    private sampler: unknown;
+
+    constructor(process: Process, interval: number) {
+        this.sampler = ProcessUtils.createSampler(process.handle, interval);
+    }
+
+    tail(options: SamplerTail): SamplerChannel {
+        return ProcessUtils.samplerTail(
+            this.sampler,
+            options.items,
+            options.size,
+            options.header,
+            options.type,
+            options.min ?? -Infinity,
+            options.max ?? Infinity,
+            options.capacity ?? 4096
+        );
+    }
+
+    snapshot(chains: PointerChain[], capacity: number = 256): SamplerChannel {
+        return ProcessUtils.samplerSnapshot(this.sampler, chains, capacity);
+    }
+
+    /** Returns the records published since the last call, back to back */
+    drain(channel: SamplerChannel): Float64Array {
+        return ProcessUtils.drainSampler(channel);
+    }
+
+    remove(channel: SamplerChannel): void {
+        ProcessUtils.removeSamplerChannel(this.sampler, channel);
+    }
+
+    setInterval(interval: number): void {
+        ProcessUtils.setSamplerInterval(this.sampler, interval);
+    }
+
+    stop(): void {
+        ProcessUtils.stopSampler(this.sampler);
+    }
+}
+
+export interface ProcessEvent {
+    type: 'attach' | 'detach';
+    pid: number;
+    path: string;
+    commandLine: string;
+    cwd: string;
+    is64bit: boolean;
+    /** Unix time in milliseconds, 0 if unknown */
+    startTime: number;
+}
+
+/**
+ * Reports processes matching `names` as they start and exit. New processes
+ * are found by a native process list walk every `interval` milliseconds,
+ * exits are reported as soon as they happen where the OS supports pidfd.
+ * Processes that are already running are reported by the first walk.
+ */
+export class ProcessWatcher {
+    private watch: unknown;
+
+    constructor(
+        names: string[],
+        interval: number,
+        onEvents: (events: ProcessEvent[]) => void
+    ) {
+        this.watch = ProcessUtils.watchProcesses(names, interval, onEvents);
+    }
+
+    /** Stops the watcher thread, `onEvents` is not called afterwards */
+    stop(): void {
+        ProcessUtils.stopProcessWatch(this.watch);
+    }
+}
+
+/** Type of a struct field, String fields hold a pointer to a C# string */
+export enum FieldType {
+    Byte = 0,
+    Short = 1,
+    Int = 2,
+    UInt = 3,
+    Float = 4,
+    Long = 5,
+    Double = 6,
+    Pointer = 7,
+    String = 8
+}
+
+export interface StructField {
+    name: string;
+    offset: number;
+    type: FieldType;
+}
+
+/** Opaque native layout compiled by `Process.compileStruct` */
+export type StructLayout = { readonly __brand: 'StructLayout' };
+
+/**
+ * Scatter-gather read list serviced by a single native call. Requests are
+ * packed as (address, size) pairs, results land back to back in one buffer
+ * behind a success bitmap, so a whole tick can be read with a handful of
+ * syscalls. Reuse the same instance across ticks to avoid reallocations.
+ */
+export class ReadBatch {
+    private requests: Float64Array;
+    private offsets: Uint32Array;
+    private output: Uint8Array;
+    private view: DataView;
+    private statuses: Uint8Array | undefined;
+    private dataStart = 0;
+    private dataSize = 0;
+
+    count = 0;
+
+    /**
+     * With `withStatus` synchronous reads also report why each failed
+     * request failed, see `status`. The reason comes from the mapped ranges
+     * alone, so batches report Failed where single reads report Permission
+     */
+    constructor(capacity: number = 64, withStatus: boolean = false) {
+        this.requests = new Float64Array(capacity * 2);
+        this.offsets = new Uint32Array(capacity);
+        this.output = new Uint8Array(0);
+        this.view = new DataView(this.output.buffer);
+        if (withStatus) this.statuses = new Uint8Array(capacity);
+    }
+
+    /**
+     * Queues a read and returns its index for the typed getters
+     */
+    add(address: number, size: number): number {
+        if (this.count === this.offsets.length) {
+            const requests = new Float64Array(this.requests.length * 2);
+            requests.set(this.requests);
+            this.requests = requests;
+
+            const offsets = new Uint32Array(this.offsets.length * 2);
+            offsets.set(this.offsets);
+            this.offsets = offsets;
+        }
+
+        const index = this.count++;
+        this.requests[index * 2] = address;
+        this.requests[index * 2 + 1] = size;
+        this.offsets[index] = this.dataSize;
+        this.dataSize += size;
+
+        return index;
+    }
+
+    clear() {
+        this.count = 0;
+        this.dataSize = 0;
+    }
+
+    /**
+     * Executes every queued request, returns the number of successful ones
+     */
+    read(handle: number): number {
+        this.prepare();
+
+        return ProcessUtils.readBatch(
+            handle,
+            this.requests.subarray(0, this.count * 2),
+            this.output,
+            this.statuses
+        );
+    }
+
+    /**
+     * Same as `read` on the native job queue, the batch must not be changed
+     * until the promise settles
+     */
+    readAsync(handle: number): Promise<number> {
+        this.prepare();
+
+        return ProcessUtils.readBatchAsync(
+            handle,
+            this.requests.subarray(0, this.count * 2),
+            this.output
+        );
+    }
+
+    private prepare() {
+        this.dataStart = Math.ceil(this.count / 64) * 8;
+
+        if (this.statuses && this.statuses.length < this.count) {
+            this.statuses = new Uint8Array(this.offsets.length);
+        }
+
+        const size = this.dataStart + this.dataSize;
+        if (this.output.length < size) {
+            this.output = new Uint8Array(
+                Math.max(size, this.output.length * 2)
+            );
+            this.view = new DataView(this.output.buffer);
+        }
+    }
+
+    ok(index: number): boolean {
+        return (this.output[index >> 3] & (1 << (index & 7))) !== 0;
+    }
+
+    /**
+     * Why the request failed after a synchronous read, batches created
+     * without `withStatus` only tell Ok and Failed apart
+     */
+    status(index: number): ReadStatus {
+        if (this.statuses) return this.statuses[index];
+
+        return this.ok(index) ? ReadStatus.Ok : ReadStatus.Failed;
+    }
+
+    bytes(index: number): Uint8Array {
+        const start = this.dataStart + this.offsets[index];
+        const size = this.requests[index * 2 + 1];
+        return this.output.subarray(start, start + size);
+    }
+
+    byte(index: number): number {
+        return this.view.getInt8(this.dataStart + this.offsets[index]);
+    }
+
+    short(index: number): number {
+        return this.view.getInt16(this.dataStart + this.offsets[index], true);
+    }
+
+    int(index: number): number {
+        return this.view.getInt32(this.dataStart + this.offsets[index], true);
+    }
+
+    uint(index: number): number {
+        return this.view.getUint32(this.dataStart + this.offsets[index], true);
+    }
+
+    float(index: number): number {
+        return this.view.getFloat32(
+            this.dataStart + this.offsets[index],
+            true
+        );
+    }
+
+    double(index: number): number {
+        return this.view.getFloat64(
+            this.dataStart + this.offsets[index],
+            true
+        );
+    }
+
+    long(index: number): number {
+        return Number(
+            this.view.getBigInt64(this.dataStart + this.offsets[index], true)
+        );
+    }
+
+    intPtr(index: number, bitness: number): number {
+        return bitness === 64 ? this.long(index) : this.int(index);
+    }
+}
+
+/** Why a read failed, reported by the `tryRead*` methods */
+export enum ReadStatus {
+    Ok = 0,
+    /** The address is in the first 64 KiB, a null pointer plus an offset */
+    ZeroPointer = 1,
+    /** Nothing readable is mapped at the address */
+    Unmapped = 2,
+    /** The read starts in readable memory but runs past its end */
+    Partial = 3,
+    /** The system denied access to the process */
+    Permission = 4,
+    Failed = 5
+}
+
+/**
+ * Syscall used for reads on Linux. Auto reads small values with
+ * process_vm_readv and measures both backends on the first large reads,
+ * such as scan chunks, before keeping the faster one.
+ */
+export enum ReadBackend {
+    Auto = 0,
+    VmReadv = 1,
+    /** pread on a /proc/<pid>/mem descriptor kept open with the handle */
+    ProcMem = 2
+}
+
+export enum LogLevel {
+    Debug = 0,
+    Info = 1,
+    Warn = 2,
+    Error = 3
+}
+
+export interface LogRecord {
+    level: LogLevel;
+    message: string;
+    /** Records of the same call site dropped by the rate limit before this one */
+    suppressed: number;
+}
+
 export class Process {
     public id: number;
     public handle: number;
     public bitness: number;
+    /** Status of the last `tryRead*` call made without its own status array */
+    public readonly status = new Uint8Array(1);
 
     constructor(id: number, bitness: number) {
         this.id = id;
@@ -60,6 +662,62 @@ export class Process {
         return ProcessUtils.getProcessStartTime(this.handle);
     }
 
+    /**
+     * Whether `size` bytes at `address` are mapped readable. Answered from
+     * a native cache of the mapped ranges, reads check it too so pointers
+     * into unmapped memory fail without a syscall
+     */
+    isReadable(address: number, size: number = 1): boolean {
+        return ProcessUtils.isReadable(this.handle, address, size);
+    }
+
+    /** Returns false if the backend is not available for this process */
+    setReadBackend(backend: ReadBackend): boolean {
+        return ProcessUtils.setReadBackend(this.handle, backend);
+    }
+
+    /** Backend used for large reads, Auto while it is still being measured */
+    getReadBackend(): ReadBackend {
+        return ProcessUtils.getReadBackend(this.handle);
+    }
+
+    /** Counters of every operation on this process since the last `resetStats` */
+    getStats(): ProcessStats {
+        return ProcessUtils.getStats(this.handle);
+    }
+
+    resetStats(): void {
+        ProcessUtils.resetStats(this.handle);
+    }
+
+    /**
+     * Records reads, scans and pattern hits of every process into a ring of
+     * `capacity` events, the oldest ones are dropped once it is full
+     */
+    static startTrace(capacity: number = 65536): void {
+        ProcessUtils.startTrace(capacity);
+    }
+
+    static stopTrace(): void {
+        ProcessUtils.stopTrace();
+    }
+
+    /** Recorded events as Chrome trace-event JSON, opens in Perfetto */
+    static dumpTrace(): string {
+        return ProcessUtils.dumpTrace();
+    }
+
+    /**
+     * Sends native log records at or above `level` to `handler` in batches
+     * instead of stdout, null restores stdout
+     */
+    static setLogHandler(
+        handler: ((records: LogRecord[]) => void) | null,
+        level: LogLevel = LogLevel.Info
+    ): void {
+        ProcessUtils.setLogHandler(handler, level);
+    }
+
     static isProcess64bit(pid: number): boolean {
         return ProcessUtils.isProcess64bit(pid);
     }
@@ -212,6 +870,20 @@ export class Process {
         );
     }
 
+    /**
+     * Reads many C# strings in one call, unreadable ones come back as null.
+     * Unchanged strings are returned from a native cache without re-decoding
+     */
+    readSharpStrings(addresses: number[] | Float64Array): (string | null)[] {
+        return ProcessUtils.readCSharpStrings(
+            this.handle,
+            this.bitness,
+            addresses instanceof Float64Array
+                ? addresses
+                : Float64Array.from(addresses)
+        );
+    }
+
     readSharpStringPtr(address: number): string {
         const addr = this.readIntPtr(address);
 
@@ -222,18 +894,38 @@ export class Process {
         return ProcessUtils.readCSharpString(this.handle, this.bitness, addr);
     }
 
-    readSharpDictionary(address: number): number[] {
-        const result = [];
-        const items = this.readInt(address + 0x8);
-        const size = this.readInt(address + 0x1c);
-
-        for (let i = 0; i < size; i++) {
-            const address = items + 0x8 + 0x10 * i;
-
-            result.push(address);
-        }
+    /**
+     * Element pointers of a List<T> of reference types, read natively with
+     * one read for the list and one for its backing array
+     */
+    readSharpList(address: number): Float64Array {
+        return ProcessUtils.readSharpList(this.handle, this.bitness, address);
+    }
 
-        return result;
+    /**
+     * Used entries of a Dictionary<K, V>, the header and the whole entries
+     * array are read at once and free entries are filtered natively
+     */
+    readSharpDictionary<
+        K extends Float64Array | string[] = Float64Array,
+        V extends Float64Array | string[] = Float64Array
+    >(address: number, layout: DictionaryLayout): SharpDictionary<K, V> {
+        return ProcessUtils.readSharpDictionary(
+            this.handle,
+            this.bitness,
+            address,
+            [
+                layout.entries,
+                layout.count,
+                layout.entrySize,
+                layout.hash ?? -1,
+                layout.next ?? -1,
+                layout.key[0],
+                layout.key[1],
+                layout.value[0],
+                layout.value[1]
+            ]
+        );
     }
 
     readNullableInt(address: number): number | undefined {
@@ -244,25 +936,18 @@ export class Process {
     }
 
     readSharpDictionaryIntToRef(address: number): DictionaryIntToRefEntry[] {
-        const result = [];
-
-        const entriesArray = this.readIntPtr(address + 0x8 + 0x8);
-
-        const entriesLength = this.readInt(entriesArray + 0x8);
-        for (let i = 0; i < entriesLength; i++) {
-            const entrySize = 24;
-            const entry = entriesArray + 0x8 + 0x8 + i * entrySize;
-
-            const hash = this.readInt(entry + 0x8);
-            if (hash === 0) continue;
-
-            const entryAddress = this.readIntPtr(entry);
-            const entryKey = this.readInt(entry + 0x10);
+        const { keys, values } = this.readSharpDictionary(address, {
+            entries: 0x10,
+            count: 0x38,
+            entrySize: 24,
+            next: 0xc,
+            key: [0x10, FieldType.Int],
+            value: [0x0, FieldType.Pointer]
+        });
 
-            result.push({
-                key: entryKey,
-                address: entryAddress
-            });
+        const result: DictionaryIntToRefEntry[] = [];
+        for (let i = 0; i < keys.length; i++) {
+            result.push({ key: keys[i], address: values[i] });
         }
 
         return result;
@@ -283,6 +968,169 @@ export class Process {
         return { signature, mask, nonZeroMask: false };
     }
 
+    compileChain(
+        base: number,
+        offsets: number[],
+        type: ChainType
+    ): PointerChain {
+        return ProcessUtils.compileChain(base, offsets, type, this.bitness);
+    }
+
+    evaluateChains(
+        chains: PointerChain[],
+        values: Float64Array,
+        statuses: Uint8Array
+    ): number {
+        return ProcessUtils.evaluateChains(
+            this.handle,
+            chains,
+            values,
+            statuses
+        );
+    }
+
+    compileStruct(fields: StructField[]): StructLayout {
+        return ProcessUtils.compileStruct(fields, this.bitness);
+    }
+
+    /**
+     * Reads every field of the layout with a single read, returns null if the
+     * object is not readable. Pass `target` to reuse the same object per tick
+     */
+    readStruct<T extends object>(
+        layout: StructLayout,
+        address: number,
+        target?: T
+    ): T | null {
+        return ProcessUtils.readStruct(this.handle, layout, address, target);
+    }
+
+    /**
+     * Same as readStruct but writes field values by index into `values`,
+     * string fields are left as their pointer
+     */
+    readStructValues(
+        layout: StructLayout,
+        address: number,
+        values: Float64Array
+    ): boolean {
+        return ProcessUtils.readStructValues(
+            this.handle,
+            layout,
+            address,
+            values
+        );
+    }
+
+    readBatch(batch: ReadBatch): number {
+        return batch.read(this.handle);
+    }
+
+    readBatchAsync(batch: ReadBatch): Promise<number> {
+        return batch.readAsync(this.handle);
+    }
+
+    /**
+     * The `tryRead*` methods never throw: a failed read returns 0 and
+     * leaves a ReadStatus in `status[0]`, which is cheaper than catching
+     * errors when most pointers may be invalid, such as during scene changes
+     */
+    tryReadIntPtr(address: number, status: Uint8Array = this.status): number {
+        return this.bitness === 64
+            ? ProcessUtils.tryReadLong(
+                  this.handle,
+                  this.bitness,
+                  address,
+                  status
+              )
+            : ProcessUtils.tryReadInt(
+                  this.handle,
+                  this.bitness,
+                  address,
+                  status
+              );
+    }
+
+    tryReadByte(address: number, status: Uint8Array = this.status): number {
+        return ProcessUtils.tryReadByte(
+            this.handle,
+            this.bitness,
+            address,
+            status
+        );
+    }
+
+    tryReadShort(address: number, status: Uint8Array = this.status): number {
+        return ProcessUtils.tryReadShort(
+            this.handle,
+            this.bitness,
+            address,
+            status
+        );
+    }
+
+    tryReadInt(address: number, status: Uint8Array = this.status): number {
+        return ProcessUtils.tryReadInt(
+            this.handle,
+            this.bitness,
+            address,
+            status
+        );
+    }
+
+    tryReadUInt(address: number, status: Uint8Array = this.status): number {
+        return ProcessUtils.tryReadUInt(
+            this.handle,
+            this.bitness,
+            address,
+            status
+        );
+    }
+
+    tryReadLong(address: number, status: Uint8Array = this.status): number {
+        return ProcessUtils.tryReadLong(
+            this.handle,
+            this.bitness,
+            address,
+            status
+        );
+    }
+
+    tryReadFloat(address: number, status: Uint8Array = this.status): number {
+        return ProcessUtils.tryReadFloat(
+            this.handle,
+            this.bitness,
+            address,
+            status
+        );
+    }
+
+    tryReadDouble(address: number, status: Uint8Array = this.status): number {
+        return ProcessUtils.tryReadDouble(
+            this.handle,
+            this.bitness,
+            address,
+            status
+        );
+    }
+
+    /** Same as `readInto` but returns a ReadStatus instead of throwing */
+    tryReadInto(
+        address: number,
+        target: ArrayBuffer | ArrayBufferView,
+        offset: number = 0,
+        length: number = target.byteLength - offset
+    ): ReadStatus {
+        return ProcessUtils.tryReadInto(
+            this.handle,
+            this.bitness,
+            address,
+            target,
+            offset,
+            length
+        );
+    }
+
     readBuffer(address: number, size: number): Buffer {
         return ProcessUtils.readBuffer(
             this.handle,
@@ -292,63 +1140,189 @@ export class Process {
         );
     }
 
-    scanSync(pattern: string, nonZeroMask: boolean = false): number {
+    /**
+     * Reads `length` bytes straight into `target` starting at byte `offset`
+     * of its view, without intermediate buffers
+     */
+    readInto(
+        address: number,
+        target: ArrayBuffer | ArrayBufferView,
+        offset: number = 0,
+        length: number = target.byteLength - offset
+    ): number {
+        return ProcessUtils.readInto(
+            this.handle,
+            this.bitness,
+            address,
+            target,
+            offset,
+            length
+        );
+    }
+
+    readFloatArray(
+        address: number,
+        target: Float32Array,
+        count: number = target.length
+    ): Float32Array {
+        this.readInto(address, target, 0, count * 4);
+        return target;
+    }
+
+    readInt32Array(
+        address: number,
+        target: Int32Array,
+        count: number = target.length
+    ): Int32Array {
+        this.readInto(address, target, 0, count * 4);
+        return target;
+    }
+
+    /**
+     * Reads `count` pointers of the process bitness into `target`
+     */
+    readPtrArray(
+        address: number,
+        target: Float64Array,
+        count: number = target.length
+    ): Float64Array {
+        ProcessUtils.readPtrArray(
+            this.handle,
+            this.bitness,
+            address,
+            target,
+            count
+        );
+        return target;
+    }
+
+    /** Lists the regions of the process, by default every readable one */
+    getRegions(filter?: RegionFilter): MemoryRegion[] {
+        return ProcessUtils.getRegions(this.handle, filter);
+    }
+
+    scanSync(
+        pattern: string,
+        nonZeroMask: boolean = false,
+        filter?: RegionFilter
+    ): number {
         const result = Process.buildPattern(pattern);
 
         return ProcessUtils.scanSync(
             this.handle,
             result.signature,
             result.mask,
-            nonZeroMask
+            nonZeroMask,
+            filter
         );
     }
 
-    scanAll(pattern: string, nonZeroMask: boolean = false): number[] {
+    scanAll(
+        pattern: string,
+        nonZeroMask: boolean = false,
+        filter?: RegionFilter
+    ): number[] {
         const result = Process.buildPattern(pattern);
 
         return ProcessUtils.scanAll(
             this.handle,
             result.signature,
             result.mask,
-            nonZeroMask
+            nonZeroMask,
+            filter
         );
     }
 
+    /**
+     * Scans on the native job queue, `callback` receives 0 if nothing was
+     * found or the scan was cancelled
+     */
     scan(
         pattern: string,
         callback: (address: number) => void,
-        nonZeroMask: boolean = false
+        nonZeroMask: boolean = false,
+        filter?: RegionFilter
     ): void {
+        this.scanAsync(pattern, nonZeroMask, filter).then(callback, () =>
+            callback(0)
+        );
+    }
+
+    /**
+     * Resolves with 0 if nothing was found, rejects once the scan is
+     * cancelled by `cancelJobs` or the process going away
+     */
+    scanAsync(
+        pattern: string,
+        nonZeroMask: boolean = false,
+        filter?: RegionFilter
+    ): Promise<number> {
         const result = Process.buildPattern(pattern);
 
-        ProcessUtils.scan(
+        return ProcessUtils.scanAsync(
             this.handle,
             result.signature,
             result.mask,
-            callback,
-            nonZeroMask
+            nonZeroMask,
+            filter
         );
     }
 
-    scanAsync(pattern: string, nonZeroMask: boolean = false): Promise<number> {
+    scanAllAsync(
+        pattern: string,
+        nonZeroMask: boolean = false,
+        filter?: RegionFilter
+    ): Promise<number[]> {
         const result = Process.buildPattern(pattern);
 
-        return new Promise((resolve, reject) => {
-            try {
-                ProcessUtils.scan(
-                    this.handle,
-                    result.signature,
-                    result.mask,
-                    resolve,
-                    nonZeroMask
-                );
-            } catch (e) {
-                reject(e);
-            }
-        });
+        return ProcessUtils.scanAllAsync(
+            this.handle,
+            result.signature,
+            result.mask,
+            nonZeroMask,
+            filter
+        );
+    }
+
+    /**
+     * @param cachePath file remembering resolved addresses per game binary,
+     * cached entries are checked against the signature before they are used
+     */
+    scanBatch(
+        signatures: Signature[],
+        cachePath?: string,
+        filter?: RegionFilter
+    ): PatternResult[] {
+        return ProcessUtils.batchScan(
+            this.handle,
+            Process.buildPatterns(signatures),
+            cachePath,
+            filter
+        );
+    }
+
+    scanBatchAsync(
+        signatures: Signature[],
+        cachePath?: string,
+        filter?: RegionFilter
+    ): Promise<PatternResult[]> {
+        return ProcessUtils.batchScanAsync(
+            this.handle,
+            Process.buildPatterns(signatures),
+            cachePath,
+            filter
+        );
+    }
+
+    /**
+     * Cancels the pending scans and async reads of this process, their
+     * promises reject. Returns the number of cancelled jobs
+     */
+    cancelJobs(): number {
+        return ProcessUtils.cancelJobs(this.handle);
     }
 
-    scanBatch(signatures: Signature[]): PatternResult[] {
+    private static buildPatterns(signatures: Signature[]): Pattern[] {
         const patterns: Pattern[] = [];
 
         for (const signature of signatures) {
@@ -357,11 +1331,12 @@ export class Process {
             patterns.push({
                 signature: result.signature,
                 mask: result.mask,
-                nonZeroMask: signature.nonZeroMask
+                nonZeroMask: signature.nonZeroMask,
+                all: signature.all
             });
         }
 
-        return ProcessUtils.batchScan(this.handle, patterns);
+        return patterns;
     }
 
     async getRootPath() {